@@ -0,0 +1,62 @@
+#include "adjacency_arena.hpp"
+
+#include <algorithm> // for copy_n
+
+namespace {
+// Size class of a list with `size` entries: blocks hold 2^class slots
+int sizeClass(int size) {
+  int c = 1;
+  while ((1 << c) < size)
+    ++c;
+  return c;
+}
+} // namespace
+
+void AdjacencyArena::addNode() { offset.push_back(-1); }
+
+std::int64_t AdjacencyArena::allocate(int sizeClass) {
+  std::vector<std::int64_t> &free = freeBlocks[sizeClass];
+  if (!free.empty()) {
+    std::int64_t block = free.back();
+    free.pop_back();
+    return block;
+  }
+  std::int64_t block = static_cast<std::int64_t>(pool.size());
+  pool.resize(pool.size() + (std::size_t(1) << sizeClass));
+  return block;
+}
+
+void AdjacencyArena::append(int node, int size, int neighbor) {
+  if (size == 0) {
+    offset[node] = allocate(1);
+  } else if (size >= 2 && (size & (size - 1)) == 0) {
+    // Block full: move to one twice as large, recycle the old one
+    int c = sizeClass(size);
+    std::int64_t block = allocate(c + 1);
+    std::copy_n(pool.begin() + offset[node], size, pool.begin() + block);
+    freeBlocks[c].push_back(offset[node]);
+    offset[node] = block;
+  }
+  pool[offset[node] + size] = neighbor;
+}
+
+void AdjacencyArena::reserve(int numNodes, std::int64_t numEntries) {
+  offset.reserve(numNodes);
+  // Most nodes keep small lists; blocks are at most twice their size
+  pool.reserve(static_cast<std::size_t>(2 * numEntries));
+}
+
+void AdjacencyArena::clear() {
+  offset.clear();
+  pool.clear();
+  for (std::vector<std::int64_t> &free : freeBlocks)
+    free.clear();
+}
+
+std::size_t AdjacencyArena::bytes() const {
+  std::size_t total = offset.capacity() * sizeof(std::int64_t) +
+                      pool.capacity() * sizeof(int);
+  for (const std::vector<std::int64_t> &free : freeBlocks)
+    total += free.capacity() * sizeof(std::int64_t);
+  return total;
+}
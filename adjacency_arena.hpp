@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Neighbor lists of all nodes in one pool instead of one heap vector per
+// node. A list of s entries lives in a block of 2^⌈log2 max(s, 2)⌉ slots;
+// when it fills up it moves to a block twice as large and the old block goes
+// to a free list of its size class, to be reused by the next list that
+// grows into it. The caller keeps the list sizes (the node degrees), so the
+// arena needs only a block offset per node.
+class AdjacencyArena {
+public:
+  void addNode();                                 // next node, empty list
+  void append(int node, int size, int neighbor); // list holds `size` entries
+  const int *list(int node) const { return pool.data() + offset[node]; }
+
+  void reserve(int numNodes, std::int64_t numEntries);
+  void clear();
+  std::size_t bytes() const; // memory held, including free blocks
+
+private:
+  std::vector<std::int64_t> offset; // block of node i in pool
+  std::vector<int> pool;
+  std::vector<std::int64_t> freeBlocks[48]; // by log2 of the block size
+
+  std::int64_t allocate(int sizeClass);
+};
@@ -0,0 +1,261 @@
+#include "async_writer.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(QN_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+// ---- FileSink ----
+
+#if defined(QN_HAVE_ZLIB)
+struct FileSink::Deflater {
+  z_stream stream{};
+  std::vector<unsigned char> out = std::vector<unsigned char>(1 << 18);
+};
+#else
+struct FileSink::Deflater {};
+#endif
+
+namespace {
+bool endsWith(const std::string &text, const char *suffix) {
+  std::string tail(suffix);
+  return text.size() >= tail.size() &&
+         text.compare(text.size() - tail.size(), tail.size(), tail) == 0;
+}
+} // namespace
+
+FileSink::FileSink(const std::string &filename_, bool append)
+    : filename(filename_) {
+  bool compressed = endsWith(filename, ".gz");
+  if (compressed && !compressionAvailable())
+    throw std::runtime_error("Cannot write " + filename +
+                             ": built without zlib");
+  file = std::fopen(filename.c_str(), append ? "ab" : "wb");
+  if (!file)
+    throw std::runtime_error("Cannot open " + filename + " for writing");
+  std::setvbuf(file, nullptr, _IONBF, 0); // writers hand over big chunks
+#if defined(QN_HAVE_ZLIB)
+  if (compressed) {
+    // Fastest level: exports shrink 2-4x at disk speed. Appending starts a
+    // new gzip member, which gzip readers concatenate.
+    deflater = std::make_unique<Deflater>();
+    if (deflateInit2(&deflater->stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      std::fclose(file);
+      throw std::runtime_error("Cannot compress " + filename);
+    }
+  }
+#endif
+}
+
+FileSink::~FileSink() {
+  try {
+    close();
+  } catch (const std::exception &) {
+    // Destructors must not throw; call close() to see write errors
+  }
+}
+
+bool FileSink::compressionAvailable() {
+#if defined(QN_HAVE_ZLIB)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void FileSink::writeRaw(const char *data, std::size_t size) {
+  if (!file)
+    throw std::runtime_error("Cannot write " + filename + ": closed");
+  if (size > 0 && std::fwrite(data, 1, size, file) != size)
+    throw std::runtime_error("Cannot write " + filename);
+}
+
+void FileSink::write(const char *data, std::size_t size) {
+#if defined(QN_HAVE_ZLIB)
+  if (deflater) {
+    z_stream &stream = deflater->stream;
+    stream.next_in =
+        reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    while (stream.avail_in > 0) {
+      stream.next_out = deflater->out.data();
+      stream.avail_out = static_cast<uInt>(deflater->out.size());
+      deflate(&stream, Z_NO_FLUSH);
+      writeRaw(reinterpret_cast<const char *>(deflater->out.data()),
+               deflater->out.size() - stream.avail_out);
+    }
+    return;
+  }
+#endif
+  writeRaw(data, size);
+}
+
+void FileSink::close() {
+  if (!file)
+    return;
+  bool written = true;
+#if defined(QN_HAVE_ZLIB)
+  if (deflater) {
+    z_stream &stream = deflater->stream;
+    int status = Z_OK;
+    while (written && status != Z_STREAM_END) {
+      stream.next_out = deflater->out.data();
+      stream.avail_out = static_cast<uInt>(deflater->out.size());
+      status = deflate(&stream, Z_FINISH);
+      std::size_t bytes = deflater->out.size() - stream.avail_out;
+      written = std::fwrite(deflater->out.data(), 1, bytes, file) == bytes &&
+                status != Z_STREAM_ERROR;
+    }
+    deflateEnd(&stream);
+    deflater.reset();
+  }
+#endif
+  std::FILE *closing = file;
+  file = nullptr;
+  if (std::fclose(closing) != 0 || !written)
+    throw std::runtime_error("Cannot write " + filename);
+}
+
+// ---- AsyncWriter ----
+
+namespace {
+struct Task {
+  std::shared_ptr<FileSink> sink;
+  std::vector<char> data;
+  bool close = false;
+};
+
+struct WriterState {
+  std::mutex mutex;
+  std::condition_variable work;    // tasks queued, or stopping
+  std::condition_variable written; // a batch was written
+  std::vector<Task> incoming;      // filled by producers
+  std::deque<std::vector<char>> pool;
+  std::vector<std::string> errors;
+  std::size_t queuedBytes = 0;
+  std::size_t maxQueuedBytes = 0;
+  bool stopping = false;
+  std::thread thread;
+};
+
+WriterState state;
+bool active = false; // changed only by start() and stop(), without producers
+constexpr std::size_t kPoolBuffers = 16;
+} // namespace
+
+void AsyncWriter::start(std::size_t maxQueuedBytes) {
+  if (active)
+    return;
+  state.maxQueuedBytes = maxQueuedBytes;
+  state.stopping = false;
+  state.errors.clear();
+  active = true;
+  state.thread = std::thread([] {
+    std::vector<Task> draining;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    for (;;) {
+      state.work.wait(lock, [] {
+        return !state.incoming.empty() || state.stopping;
+      });
+      if (state.incoming.empty())
+        return; // stopping, and everything is written
+      draining.swap(state.incoming);
+
+      // Write without the lock; failures are recorded under it below
+      lock.unlock();
+      std::vector<std::string> failures(draining.size());
+      for (std::size_t t = 0; t < draining.size(); ++t) {
+        Task &task = draining[t];
+        if (!task.sink->failure.empty())
+          continue; // the file already failed: drop its data
+        try {
+          task.sink->write(task.data.data(), task.data.size());
+          if (task.close)
+            task.sink->close();
+        } catch (const std::exception &e) {
+          failures[t] = e.what();
+        }
+      }
+      lock.lock();
+
+      for (std::size_t t = 0; t < draining.size(); ++t) {
+        Task &task = draining[t];
+        if (!failures[t].empty() && task.sink->failure.empty()) {
+          task.sink->failure = failures[t];
+          state.errors.push_back(failures[t]); // names the file
+        }
+        task.sink->queued--;
+        state.queuedBytes -= task.data.size();
+        if (state.pool.size() < kPoolBuffers && task.data.capacity() > 0)
+          state.pool.push_back(std::move(task.data));
+      }
+      draining.clear(); // drops the sinks, closing failed ones
+      state.written.notify_all();
+    }
+  });
+}
+
+std::vector<std::string> AsyncWriter::stop() {
+  if (!active)
+    return {};
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stopping = true;
+  }
+  state.work.notify_all();
+  state.thread.join();
+  active = false;
+  state.pool.clear();
+  return std::move(state.errors);
+}
+
+bool AsyncWriter::running() { return active; }
+
+void AsyncWriter::submit(const std::shared_ptr<FileSink> &sink,
+                         std::vector<char> data, bool close) {
+  if (!active) {
+    sink->write(data.data(), data.size());
+    if (close)
+      sink->close();
+    return;
+  }
+  std::unique_lock<std::mutex> lock(state.mutex);
+  // Back-pressure: bounded memory if the disk cannot keep up
+  state.written.wait(lock, [&] {
+    return state.queuedBytes == 0 ||
+           state.queuedBytes + data.size() <= state.maxQueuedBytes;
+  });
+  state.queuedBytes += data.size();
+  sink->queued++;
+  state.incoming.push_back({sink, std::move(data), close});
+  lock.unlock();
+  state.work.notify_one();
+}
+
+void AsyncWriter::wait(FileSink &sink) {
+  if (!active)
+    return;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.written.wait(lock, [&] { return sink.queued == 0; });
+  if (!sink.failure.empty())
+    throw std::runtime_error(sink.failure);
+}
+
+std::vector<char> AsyncWriter::takeBuffer(std::size_t size) {
+  std::vector<char> buffer;
+  if (active) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.pool.empty()) {
+      buffer = std::move(state.pool.back());
+      state.pool.pop_back();
+    }
+  }
+  buffer.resize(size);
+  return buffer;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// An output file for CsvWriter and EventLogWriter, gzip-compressed when the
+// name ends in ".gz" (builds with zlib only, see compressionAvailable()).
+// Used by one thread at a time: its writer's, or AsyncWriter's.
+class FileSink {
+public:
+  FileSink(const std::string &filename, bool append); // throws if unopenable
+  ~FileSink(); // closes; errors are only reported by close()
+
+  FileSink(const FileSink &) = delete;
+  FileSink &operator=(const FileSink &) = delete;
+
+  void write(const char *data, std::size_t size); // throws std::runtime_error
+  void close();                                   // throws std::runtime_error
+  const std::string &name() const { return filename; }
+
+  static bool compressionAvailable();
+
+private:
+  friend class AsyncWriter;
+  std::string filename;
+  std::FILE *file = nullptr;
+  struct Deflater;
+  std::unique_ptr<Deflater> deflater; // only for .gz
+
+  // Owned by AsyncWriter (under its lock)
+  int queued = 0;      // tasks not yet written
+  std::string failure; // first write error, empty if none
+
+  void writeRaw(const char *data, std::size_t size);
+};
+
+// Process-wide background writer, off by default (like Profiler). While it
+// runs, CsvWriter and EventLogWriter hand their full buffers to it instead
+// of writing them, so a job thread never waits for the disk: metric rows do
+// not stall growth, and one job's exports are written while the next job
+// grows. Producers append to one queue under a short lock; the writer
+// thread swaps it for its own (double buffering) and writes without the
+// lock, returning the buffers to a pool for reuse. Producers only block
+// while more than maxQueuedBytes are queued, or in wait().
+//
+// Write errors cannot be thrown where they happen: the file's later data is
+// dropped, wait() on it throws, and stop() returns every error.
+class AsyncWriter {
+public:
+  static void start(std::size_t maxQueuedBytes = std::size_t(256) << 20);
+  // Writes and closes everything queued, joins the thread; returns the
+  // write errors since start(), one per failed file. Call once producers
+  // are done.
+  static std::vector<std::string> stop();
+  static bool running();
+
+  // Queues `data` for `sink`, then closes it if `close`; writes in the
+  // calling thread (throwing on errors) when the writer is not running
+  static void submit(const std::shared_ptr<FileSink> &sink,
+                     std::vector<char> data, bool close = false);
+  // Returns once everything queued for `sink` is written; throws its error
+  static void wait(FileSink &sink);
+  // A buffer of `size` bytes, recycled from written ones where possible
+  static std::vector<char> takeBuffer(std::size_t size);
+};
@@ -0,0 +1,553 @@
+// quantum_net_bench: fixed-seed growth scenarios (Fermi/Bose x low/high β x
+// N) timed phase by phase, generic std::function growth against the
+// compiled kernels, the memory per triangle of full and lean storage,
+// lockstep replica ensembles against one network per seed, and simplicial
+// growth in dimensions 2 to 4 against Network.
+// Prints one JSON document so results can be diffed and plotted across
+// commits and machines.
+#include "growth_engine.hpp"
+#include "metrics.hpp"
+#include "metrics_tracker.hpp"
+#include "network.hpp"
+#include "profiler.hpp"
+#include "replica_ensemble.hpp"
+#include "simplicial_network.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if !defined(__linux__) && !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+struct Scenario {
+  std::string statistics; // fermi | bose
+  double beta;
+  int triangles;
+};
+
+struct BenchOptions {
+  int maxTriangles = 1000000;
+  int memoryTriangles = 10000000; // largest memory scenario, 0 = none
+  int replicas = 8;                // replicas per ensemble scenario
+  std::string outputFile; // empty = stdout
+  fs::path scratchDir = fs::temp_directory_path() / "quantum_net_bench";
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+double timeCall(const std::function<void()> &call) {
+  auto start = std::chrono::steady_clock::now();
+  call();
+  return secondsSince(start);
+}
+
+// Peak resident set size of this process. On Linux the high-water mark is
+// reset before every scenario, so each scenario reports its own peak.
+void resetPeakRss() {
+#if defined(__linux__)
+  std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+// Resident set size now (VmRSS), in MiB; 0 where unavailable
+double currentRssMiB() {
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0)
+      return std::stod(line.substr(6)) / 1024.0; // kB
+  }
+#endif
+  return 0.0;
+}
+
+double peakRssMiB() {
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0)
+      return std::stod(line.substr(6)) / 1024.0; // kB
+  }
+  return 0.0;
+#elif !defined(_WIN32)
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / (1024.0 * 1024.0); // bytes on macOS
+#else
+  return 0.0;
+#endif
+}
+
+Network makeNetwork(const Scenario &s) {
+  int m = s.statistics == "bose" ? INT_MAX : 2;
+  return Network(42, m, s.beta); // default linear energy
+}
+
+// Order-sensitive hash of the triangle list, to compare two growth runs
+std::uint64_t trajectoryHash(const Network &net) {
+  std::uint64_t h = 1469598103934665603ULL; // FNV-1a
+  for (const Triangle &t : net.triangles) {
+    for (int v : {t.node1, t.node2, t.node3}) {
+      h ^= static_cast<std::uint32_t>(v);
+      h *= 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+// Order-sensitive hash of the link list, which both storages keep
+std::uint64_t linkHash(const Network &net) {
+  std::uint64_t h = 1469598103934665603ULL; // FNV-1a
+  for (const Link &link : net.getLinks()) {
+    for (int v : {link.node1, link.node2, link.numTriangles}) {
+      h ^= static_cast<std::uint32_t>(v);
+      h *= 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+// Grows N triangles with the compiled kernel in full and in lean storage and
+// reports the peak RSS growth per triangle (Linux) next to the bytes the
+// network's containers hold
+std::string runMemoryScenario(const Scenario &s) {
+  std::ostringstream json;
+  json.precision(6);
+  int m = s.statistics == "bose" ? INT_MAX : 2;
+  json << "{\"statistics\":\"" << s.statistics << "\",\"beta\":" << s.beta
+       << ",\"triangles\":" << s.triangles;
+
+  std::uint64_t fullHash = 0;
+  for (NetworkStorage storage : {NetworkStorage::Full, NetworkStorage::Lean}) {
+    bool lean = storage == NetworkStorage::Lean;
+#if defined(__GLIBC__)
+    malloc_trim(0); // return what the previous run freed, for the baseline
+#endif
+    resetPeakRss();
+    double baseline = currentRssMiB();
+    double seconds;
+    std::size_t heapBytes;
+    std::uint64_t hash;
+    {
+      Network net = makeNetwork(s);
+      net.setStorage(storage);
+      net.initialize();
+      GrowthEngine engine(net, 7);
+      GrowthKernel grow = selectGrowthKernel(m, false);
+      seconds = timeCall([&] { grow(engine, s.triangles - 1); });
+      heapBytes = net.memoryBytes();
+      hash = linkHash(net);
+    }
+    double rssBytes = (peakRssMiB() - baseline) * 1024.0 * 1024.0;
+    if (!lean)
+      fullHash = hash;
+
+    json << ",\"" << (lean ? "lean" : "full") << "\":{\"seconds\":" << seconds
+         << ",\"bytes_per_triangle\":" << rssBytes / s.triangles
+         << ",\"heap_bytes_per_triangle\":"
+         << static_cast<double>(heapBytes) / s.triangles;
+    if (lean)
+      json << ",\"identical\":" << (hash == fullHash ? "true" : "false");
+    json << "}";
+  }
+  json << "}";
+  return json.str();
+}
+
+// Order-sensitive hash of one replica's links, comparable to linkHash
+std::uint64_t replicaLinkHash(const ReplicaEnsemble &ensemble, int replica) {
+  std::uint64_t h = 1469598103934665603ULL; // FNV-1a
+  for (int k = 0; k < ensemble.numLinks(); ++k) {
+    Link link = ensemble.link(replica, k);
+    for (int v : {link.node1, link.node2, link.numTriangles}) {
+      h ^= static_cast<std::uint32_t>(v);
+      h *= 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+// K seeds of one point: one network per seed with the compiled kernel and a
+// MetricsTracker (as quantum_net runs them), then the lockstep ensemble with
+// the scalar and the AVX2 loops. Throughput is in replica-steps per second;
+// "identical" compares every replica's links and tracked metrics with its
+// single run, and a replayed network's links and rng with the first one.
+std::string runReplicaScenario(const Scenario &s, int replicas) {
+  std::ostringstream json;
+  json.precision(6);
+  int steps = s.triangles - 1;
+  int m = s.statistics == "bose" ? INT_MAX : 2;
+  std::vector<int> seeds;
+  for (int r = 0; r < replicas; ++r)
+    seeds.push_back(42 + 1000 * r); // as --trials
+  double replicaSteps = static_cast<double>(steps) * replicas;
+
+  struct Result {
+    std::uint64_t hash;
+    int maxDistance;
+    int kMax;
+    double entropy;
+  };
+  std::vector<Result> single;
+  std::mt19937 firstRng;
+  double singleSeconds = timeCall([&] {
+    for (int seed : seeds) {
+      Network net(seed, m, s.beta);
+      net.initialize();
+      MetricsTracker tracker(net);
+      net.reserve(s.triangles);
+      GrowthEngine engine(net, 7);
+      selectGrowthKernel(m, false)(engine, steps);
+      single.push_back({linkHash(net), tracker.maxDistanceFromInitialTriangle(),
+                        tracker.maxDegree(), tracker.entropyRate()});
+      if (single.size() == 1)
+        firstRng = net.rng;
+    }
+  });
+
+  json << "{\"statistics\":\"" << s.statistics << "\",\"beta\":" << s.beta
+       << ",\"triangles\":" << s.triangles << ",\"replicas\":" << replicas
+       << ",\"single\":{\"seconds\":" << singleSeconds
+       << ",\"replica_steps_per_second\":" << replicaSteps / singleSeconds
+       << "}";
+
+  for (bool vectorized : {false, true}) {
+    ReplicaEnsemble ensemble(seeds, m, s.beta, false, 7);
+    ensemble.setVectorized(vectorized);
+    if (vectorized && !ensemble.isVectorized())
+      continue; // no AVX2 on this CPU
+    double seconds = timeCall([&] {
+      ensemble.initialize();
+      ensemble.reserve(s.triangles);
+      ensemble.grow(steps);
+    });
+
+    bool identical = true;
+    for (int r = 0; r < replicas; ++r) {
+      const Result &expected = single[r];
+      identical = identical && replicaLinkHash(ensemble, r) == expected.hash &&
+                  ensemble.maxDistance(r) == expected.maxDistance &&
+                  ensemble.maxDegree(r) == expected.kMax &&
+                  ensemble.entropyRate(r) == expected.entropy;
+    }
+    Network replayed(seeds[0], m, s.beta);
+    ensemble.replay(0, replayed);
+    identical = identical && linkHash(replayed) == single[0].hash &&
+                replayed.rng == firstRng;
+
+    json << ",\"" << (vectorized ? "ensemble_avx2" : "ensemble_scalar")
+         << "\":{\"seconds\":" << seconds
+         << ",\"replica_steps_per_second\":" << replicaSteps / seconds
+         << ",\"speedup\":" << singleSeconds / seconds
+         << ",\"bytes_per_replica_triangle\":"
+         << static_cast<double>(ensemble.memoryBytes()) /
+                (static_cast<double>(s.triangles) * replicas)
+         << ",\"identical\":" << (identical ? "true" : "false") << "}";
+  }
+  json << "}";
+  return json.str();
+}
+
+// Order-sensitive hash of the faces of SimplicialNetwork<2>, comparable to
+// linkHash (its faces are the links)
+std::uint64_t faceHash(const SimplicialNetwork<2> &net) {
+  std::uint64_t h = 1469598103934665603ULL; // FNV-1a
+  for (int k = 0; k < net.numFaces(); ++k) {
+    const Face<2> &face = net.getFace(k);
+    for (int v : {face.nodes[0], face.nodes[1], face.numSimplices}) {
+      h ^= static_cast<std::uint32_t>(v);
+      h *= 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+// Grows N D-simplices with SimplicialNetwork<D>
+template <int D>
+void growSimplicial(const Scenario &s, int m, std::ostringstream &json) {
+  SimplicialNetwork<D> net(42, m, s.beta);
+  double seconds = timeCall([&] {
+    net.initialize();
+    SimplicialGrowthEngine<D>(net, 7).growSteps(s.triangles - 1);
+  });
+  json << ",\"d" << D << "\":{\"seconds\":" << seconds
+       << ",\"ns_per_step\":" << 1e9 * seconds / (s.triangles - 1)
+       << ",\"bytes_per_simplex\":"
+       << static_cast<double>(net.memoryBytes()) / s.triangles << "}";
+}
+
+// The compiled Network kernel with a MetricsTracker (as quantum_net runs
+// d = 2) against SimplicialNetwork<2>, which must match it exactly: links,
+// rng, node curvatures and tracked metrics; then d = 3 and 4 for scale.
+std::string runSimplicialScenario(const Scenario &s) {
+  std::ostringstream json;
+  json.precision(6);
+  int steps = s.triangles - 1;
+  int m = s.statistics == "bose" ? INT_MAX : 2;
+
+  Network net(42, m, s.beta);
+  std::unique_ptr<MetricsTracker> tracker;
+  double networkSeconds = timeCall([&] {
+    net.initialize();
+    tracker = std::make_unique<MetricsTracker>(net);
+    net.reserve(s.triangles);
+    GrowthEngine engine(net, 7);
+    selectGrowthKernel(m, false)(engine, steps);
+  });
+
+  SimplicialNetwork<2> simplicial(42, m, s.beta);
+  double seconds = timeCall([&] {
+    simplicial.initialize();
+    SimplicialGrowthEngine<2>(simplicial, 7).growSteps(steps);
+  });
+  bool identical =
+      faceHash(simplicial) == linkHash(net) && simplicial.rng == net.rng &&
+      simplicial.maxDistanceFromInitialSimplex() ==
+          tracker->maxDistanceFromInitialTriangle() &&
+      simplicial.maxDegree() == tracker->maxDegree() &&
+      simplicial.entropyRate() == tracker->entropyRate();
+  for (int i = 0; identical && i < net.numNodes(); ++i)
+    identical = simplicial.nodeCurvature(i) ==
+                1.0 - (net.degree(i) / 2.0) + (net.triangleCount(i) / 3.0);
+
+  json << "{\"statistics\":\"" << s.statistics << "\",\"beta\":" << s.beta
+       << ",\"simplices\":" << s.triangles
+       << ",\"network\":{\"seconds\":" << networkSeconds
+       << ",\"ns_per_step\":" << 1e9 * networkSeconds / steps
+       << "},\"d2\":{\"seconds\":" << seconds
+       << ",\"ns_per_step\":" << 1e9 * seconds / steps
+       << ",\"speedup\":" << networkSeconds / seconds
+       << ",\"identical\":" << (identical ? "true" : "false") << "}";
+  growSimplicial<3>(s, m, json);
+  growSimplicial<4>(s, m, json);
+  json << "}";
+  return json.str();
+}
+
+std::string runScenario(const Scenario &s, const BenchOptions &options) {
+  std::ostringstream json;
+  json.precision(6);
+  int steps = s.triangles - 1;
+  int m = s.statistics == "bose" ? INT_MAX : 2;
+
+  // Compiled growth kernel (selectGrowthKernel), as used by quantum_net
+  double kernelSeconds;
+  std::uint64_t kernelHash;
+  {
+    Network kernelNet = makeNetwork(s);
+    kernelNet.initialize();
+    GrowthEngine kernelEngine(kernelNet, 7);
+    GrowthKernel grow = selectGrowthKernel(m, false);
+    kernelSeconds = timeCall([&] { grow(kernelEngine, steps); });
+    kernelHash = trajectoryHash(kernelNet);
+  }
+
+  // Generic growth through std::function, profiler off; this network is
+  // kept for the metric and export timings below
+  resetPeakRss();
+  Network net = makeNetwork(s);
+  net.initialize();
+  GrowthEngine engine(net, 7);
+  double growSeconds = timeCall([&] { engine.growSteps(steps); });
+  bool identical = trajectoryHash(net) == kernelHash;
+
+  // Same run again with the profiler on, for the sample/add split
+  Profiler::reset();
+  Profiler::setEnabled(true);
+  {
+    Network profiled = makeNetwork(s);
+    profiled.initialize();
+    GrowthEngine profiledEngine(profiled, 7);
+    profiledEngine.growSteps(steps);
+  }
+  Profiler::setEnabled(false);
+  auto phases = Profiler::report();
+  auto perStep = [&](ProfilePhase phase) {
+    return steps > 0 ? phases[(int)phase].nanoseconds / (double)steps : 0.0;
+  };
+
+  json << "{\"statistics\":\"" << s.statistics << "\",\"beta\":" << s.beta
+       << ",\"triangles\":" << s.triangles << ",\"nodes\":" << net.numNodes()
+       << ",\"links\":" << net.numLinks() << ",\"grow\":{\"seconds\":"
+       << growSeconds << ",\"steps_per_second\":" << steps / growSeconds
+       << ",\"ns_per_step\":" << 1e9 * growSeconds / steps
+       << ",\"profiled_ns_per_step\":{\"sample_link\":"
+       << perStep(ProfilePhase::SampleLink)
+       << ",\"add_triangle\":" << perStep(ProfilePhase::AddTriangle) << "}}"
+       << ",\"kernel\":{\"seconds\":" << kernelSeconds
+       << ",\"ns_per_step\":" << 1e9 * kernelSeconds / steps
+       << ",\"speedup\":" << growSeconds / kernelSeconds
+       << ",\"identical\":" << (identical ? "true" : "false") << "}";
+
+  // One call of each Metrics function
+  std::vector<std::pair<const char *, std::function<void()>>> metrics = {
+      {"max_distance", [&] { Metrics::maxDistanceFromInitialTriangle(net); }},
+      {"max_degree", [&] { Metrics::maxDegree(net); }},
+      {"entropy_rate", [&] { Metrics::entropyRate(net); }},
+      {"average_clustering", [&] { Metrics::averageClustering(net); }},
+      {"degree_histogram", [&] { Metrics::degreeHistogram(net); }},
+      {"curvature_histogram", [&] { Metrics::curvatureHistogram(net); }},
+      {"louvain", [&] { Metrics::louvain(net, 1, 1, 42); }},
+      {"path_lengths_64", [&] { Metrics::pathLengths(net, 64, 1, 42); }},
+      {"percolation_16",
+       [&] { Metrics::percolation(net, RemovalOrder::Random, 16, 1, 42); }},
+  };
+  json << ",\"metrics_seconds\":{";
+  for (std::size_t k = 0; k < metrics.size(); ++k) {
+    json << (k > 0 ? "," : "") << "\"" << metrics[k].first
+         << "\":" << timeCall(metrics[k].second);
+  }
+  json << "}";
+
+  // Exporters, throughput in MB/s of file written
+  fs::create_directories(options.scratchDir);
+  fs::path file = options.scratchDir / "export.csv";
+  std::vector<std::pair<const char *, std::function<void()>>> exporters = {
+      {"edges", [&] { net.exportEdgeList(file.string()); }},
+      {"curvature_nodes", [&] { net.exportNodeCurvatures(file.string()); }},
+      {"links", [&] { net.exportCSV(file.string()); }},
+  };
+  json << ",\"export\":{";
+  for (std::size_t k = 0; k < exporters.size(); ++k) {
+    double seconds = timeCall(exporters[k].second);
+    double megabytes = fs::file_size(file) / 1e6;
+    json << (k > 0 ? "," : "") << "\"" << exporters[k].first
+         << "\":{\"seconds\":" << seconds << ",\"megabytes\":" << megabytes
+         << ",\"mb_per_second\":" << megabytes / seconds << "}";
+  }
+  json << "}";
+  fs::remove(file);
+
+  json << ",\"peak_rss_mib\":" << peakRssMiB() << "}";
+  return json.str();
+}
+
+std::string usage() {
+  return "Usage: quantum_net_bench [options]\n"
+         "\n"
+         "  --max-triangles N   largest scenario size (1000000)\n"
+         "  --memory-triangles N  largest memory scenario (10000000,\n"
+         "                      0 = skip); sizes 1M and 10M\n"
+         "  --replicas K        replicas per ensemble scenario (8, 0 = skip);\n"
+         "                      sizes 100k and 1M, up to --max-triangles\n"
+         "  --output FILE       write the JSON report to FILE (stdout)\n"
+         "  --scratch DIR       directory for the export files\n"
+         "  --help              show this message\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchOptions options;
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    bool hasValue = a + 1 < argc;
+    if (arg == "--max-triangles" && hasValue) {
+      options.maxTriangles = std::stoi(argv[++a]);
+    } else if (arg == "--memory-triangles" && hasValue) {
+      options.memoryTriangles = std::stoi(argv[++a]);
+    } else if (arg == "--replicas" && hasValue) {
+      options.replicas = std::stoi(argv[++a]);
+    } else if (arg == "--output" && hasValue) {
+      options.outputFile = argv[++a];
+    } else if (arg == "--scratch" && hasValue) {
+      options.scratchDir = argv[++a];
+    } else if (arg == "--help") {
+      std::cout << usage();
+      return 0;
+    } else {
+      std::cerr << "❌ unknown option '" << arg << "'\n\n" << usage();
+      return 1;
+    }
+  }
+
+  std::vector<Scenario> scenarios;
+  for (int N : {1000, 10000, 100000, 1000000}) {
+    if (N > options.maxTriangles)
+      continue;
+    for (const char *statistics : {"fermi", "bose"}) {
+      for (double beta : {0.05, 5.0})
+        scenarios.push_back({statistics, beta, N});
+    }
+  }
+
+  std::ostringstream report;
+  report << "{\"benchmark\":\"quantum_net_bench\",\"seed\":42,\"lambda\":7,"
+            "\"energy\":\"linear\",\"scenarios\":[";
+  for (std::size_t k = 0; k < scenarios.size(); ++k) {
+    const Scenario &s = scenarios[k];
+    std::cerr << "⏱️ " << s.statistics << " β=" << s.beta
+              << " N=" << s.triangles << std::endl;
+    report << (k > 0 ? ",\n" : "\n") << runScenario(s, options);
+  }
+  report << "\n],\"memory\":[";
+  int memoryRuns = 0;
+  for (int N : {1000000, 10000000}) {
+    if (N > options.memoryTriangles)
+      continue;
+    for (const char *statistics : {"fermi", "bose"}) {
+      Scenario s{statistics, 0.05, N};
+      std::cerr << "🧮 memory " << s.statistics << " β=" << s.beta
+                << " N=" << s.triangles << std::endl;
+      report << (memoryRuns++ > 0 ? ",\n" : "\n") << runMemoryScenario(s);
+    }
+  }
+  report << "\n],\"replicas\":[";
+  int replicaRuns = 0;
+  for (int N : {100000, 1000000}) {
+    if (N > options.maxTriangles || options.replicas <= 0)
+      continue;
+    for (const char *statistics : {"fermi", "bose"}) {
+      Scenario s{statistics, 0.05, N};
+      std::cerr << "🧬 replicas " << s.statistics << " β=" << s.beta
+                << " N=" << s.triangles << " K=" << options.replicas
+                << std::endl;
+      report << (replicaRuns++ > 0 ? ",\n" : "\n")
+             << runReplicaScenario(s, options.replicas);
+    }
+  }
+  report << "\n],\"simplicial\":[";
+  int simplicialRuns = 0;
+  for (int N : {100000, 1000000}) {
+    if (N > options.maxTriangles)
+      continue;
+    for (const char *statistics : {"fermi", "bose"}) {
+      Scenario s{statistics, 0.05, N};
+      std::cerr << "🔺 simplicial " << s.statistics << " β=" << s.beta
+                << " N=" << s.triangles << std::endl;
+      report << (simplicialRuns++ > 0 ? ",\n" : "\n")
+             << runSimplicialScenario(s);
+    }
+  }
+  report << "\n]}\n";
+
+  if (options.outputFile.empty()) {
+    std::cout << report.str();
+  } else {
+    std::ofstream out(options.outputFile);
+    out << report.str();
+    std::cerr << "✅ Saved: " << options.outputFile << "\n";
+  }
+  return 0;
+}
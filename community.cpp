@@ -0,0 +1,208 @@
+#include "community.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <tuple>
+
+namespace {
+// One pass of local moves; returns true if any node changed community
+bool moveNodes(const CommunityGraph &g, std::vector<int> &comm,
+               std::mt19937 &rng) {
+  int n = g.size();
+  double m2 = std::accumulate(g.strength.begin(), g.strength.end(), 0.0);
+  if (m2 <= 0.0)
+    return false;
+
+  std::vector<double> tot(n, 0.0); // Σ_tot per community
+  for (int i = 0; i < n; ++i)
+    tot[comm[i]] += g.strength[i];
+
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), rng);
+
+  std::vector<double> linkWeight(n, 0.0); // k_{i,C} for neighboring C
+  std::vector<int> touched;
+  bool movedAny = false;
+  bool moved = true;
+
+  while (moved) {
+    moved = false;
+    for (int i : order) {
+      int own = comm[i];
+      double ki = g.strength[i];
+
+      touched.clear();
+      touched.push_back(own);
+      for (int e = g.offsets[i]; e < g.offsets[i + 1]; ++e) {
+        int c = comm[g.targets[e]];
+        if (linkWeight[c] == 0.0 && c != own)
+          touched.push_back(c);
+        linkWeight[c] += g.weights[e];
+      }
+
+      tot[own] -= ki; // take i out of its community
+      int best = own;
+      double bestGain = linkWeight[own] - tot[own] * ki / m2;
+      for (int c : touched) {
+        double gain = linkWeight[c] - tot[c] * ki / m2;
+        if (gain > bestGain + 1e-12) {
+          bestGain = gain;
+          best = c;
+        }
+      }
+      tot[best] += ki;
+
+      for (int c : touched)
+        linkWeight[c] = 0.0;
+
+      if (best != own) {
+        comm[i] = best;
+        moved = true;
+        movedAny = true;
+      }
+    }
+  }
+
+  return movedAny;
+}
+
+// Renumbers communities 0..K-1 and returns K
+int renumber(std::vector<int> &comm) {
+  std::vector<int> id(comm.size(), -1);
+  int next = 0;
+  for (int &c : comm) {
+    if (id[c] < 0)
+      id[c] = next++;
+    c = id[c];
+  }
+  return next;
+}
+
+// Collapses every community into one node
+CommunityGraph aggregate(const CommunityGraph &g, const std::vector<int> &comm,
+                         int k) {
+  CommunityGraph out;
+  out.selfLoop.assign(k, 0.0);
+  out.strength.assign(k, 0.0);
+
+  std::vector<std::tuple<int, int, double>> edges;
+  for (int i = 0; i < g.size(); ++i) {
+    int ci = comm[i];
+    out.selfLoop[ci] += g.selfLoop[i];
+    out.strength[ci] += g.strength[i];
+    for (int e = g.offsets[i]; e < g.offsets[i + 1]; ++e) {
+      int cj = comm[g.targets[e]];
+      if (ci == cj)
+        out.selfLoop[ci] += g.weights[e]; // both directions are visited
+      else
+        edges.emplace_back(ci, cj, g.weights[e]);
+    }
+  }
+
+  std::sort(edges.begin(), edges.end());
+  out.offsets.assign(k + 1, 0);
+  for (std::size_t e = 0; e < edges.size(); ++e) {
+    auto [a, b, w] = edges[e];
+    if (!out.targets.empty() && e > 0 && std::get<0>(edges[e - 1]) == a &&
+        std::get<1>(edges[e - 1]) == b) {
+      out.weights.back() += w;
+      continue;
+    }
+    out.targets.push_back(b);
+    out.weights.push_back(w);
+    out.offsets[a + 1]++;
+  }
+  for (int c = 0; c < k; ++c)
+    out.offsets[c + 1] += out.offsets[c];
+
+  return out;
+}
+} // namespace
+
+double Louvain::modularity(const CommunityGraph &graph,
+                           const std::vector<int> &community) {
+  int n = graph.size();
+  int k = n > 0 ? *std::max_element(community.begin(), community.end()) + 1
+                : 0;
+  std::vector<double> in(k, 0.0), tot(k, 0.0);
+  double m2 = 0.0;
+
+  for (int i = 0; i < n; ++i) {
+    int c = community[i];
+    tot[c] += graph.strength[i];
+    in[c] += graph.selfLoop[i];
+    m2 += graph.strength[i];
+    for (int e = graph.offsets[i]; e < graph.offsets[i + 1]; ++e) {
+      if (community[graph.targets[e]] == c)
+        in[c] += graph.weights[e];
+    }
+  }
+
+  if (m2 <= 0.0)
+    return 0.0;
+
+  double Q = 0.0;
+  for (int c = 0; c < k; ++c)
+    Q += in[c] / m2 - (tot[c] / m2) * (tot[c] / m2);
+  return Q;
+}
+
+CommunityResult Louvain::runOnce(const CommunityGraph &graph, unsigned seed) {
+  std::mt19937 rng(seed);
+  int n = graph.size();
+
+  CommunityResult result;
+  result.community.resize(n);
+  std::iota(result.community.begin(), result.community.end(), 0);
+
+  CommunityGraph level = graph;
+  while (true) {
+    std::vector<int> comm(level.size());
+    std::iota(comm.begin(), comm.end(), 0);
+    if (!moveNodes(level, comm, rng))
+      break;
+
+    int k = renumber(comm);
+    for (int &c : result.community)
+      c = comm[c];
+    if (k == level.size())
+      break;
+    level = aggregate(level, comm, k);
+  }
+
+  result.numCommunities = renumber(result.community);
+  result.modularity = modularity(graph, result.community);
+  return result;
+}
+
+CommunityResult Louvain::run(const CommunityGraph &graph, int restarts,
+                             int threads, unsigned seed) {
+  restarts = std::max(1, restarts);
+  threads = std::max(1, std::min(threads, restarts));
+
+  std::vector<CommunityResult> results(restarts);
+  std::atomic<int> next{0};
+  auto worker = [&]() {
+    for (int r = next++; r < restarts; r = next++)
+      results[r] = runOnce(graph, seed + static_cast<unsigned>(r));
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (std::thread &t : pool)
+    t.join();
+
+  // Best modularity; ties go to the lowest restart, independent of timing
+  int best = 0;
+  for (int r = 1; r < restarts; ++r) {
+    if (results[r].modularity > results[best].modularity)
+      best = r;
+  }
+  return results[best];
+}
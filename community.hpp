@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+// Weighted undirected graph in CSR form, the input of one Louvain level.
+// selfLoop[i] = Σ_{a,b ∈ i} A_ab for an aggregated node i (0 at level 0).
+struct CommunityGraph {
+  std::vector<int> offsets;    // neighbors of i: [offsets[i], offsets[i+1])
+  std::vector<int> targets;    // neighbor ids (no self loops)
+  std::vector<double> weights; // A_ij
+  std::vector<double> selfLoop;
+  std::vector<double> strength; // k_i = selfLoop[i] + Σ_j A_ij
+
+  int size() const { return static_cast<int>(strength.size()); }
+};
+
+struct CommunityResult {
+  std::vector<int> community; // community[i] for every original node
+  int numCommunities = 0;
+  double modularity = 0.0;
+};
+
+// Louvain community detection (Blondel et al. 2008): greedy local moves
+// followed by aggregation, repeated while modularity improves. Independent
+// restarts with different node orders run on several threads and the best
+// partition wins; the result depends only on (seed, restarts), not on the
+// number of threads.
+class Louvain {
+public:
+  static CommunityResult run(const CommunityGraph &graph, int restarts = 4,
+                             int threads = 1, unsigned seed = 42);
+
+  // Q = Σ_c [Σ_in(c) / 2m - (Σ_tot(c) / 2m)²]
+  static double modularity(const CommunityGraph &graph,
+                           const std::vector<int> &community);
+
+private:
+  static CommunityResult runOnce(const CommunityGraph &graph, unsigned seed);
+};
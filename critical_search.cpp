@@ -0,0 +1,296 @@
+#include "critical_search.hpp"
+#include "csv_writer.hpp"
+#include "experiment.hpp"
+#include "sweep_scheduler.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+OrderParameter parseOrderParameter(const std::string &name) {
+  if (name == "max_distance")
+    return OrderParameter::MaxDistance;
+  if (name == "k_max")
+    return OrderParameter::MaxDegree;
+  if (name == "entropy")
+    return OrderParameter::EntropyRate;
+  throw std::invalid_argument("unknown order parameter '" + name + "'");
+}
+
+double orderParameterValue(const MetricRow &row, OrderParameter parameter) {
+  switch (parameter) {
+  case OrderParameter::MaxDistance:
+    return row.maxDistance;
+  case OrderParameter::MaxDegree:
+    return row.kMax;
+  case OrderParameter::EntropyRate:
+    return row.entropy;
+  }
+  return 0.0;
+}
+
+RunningStats BetaPoint::stats() const {
+  RunningStats result;
+  for (const auto &[seedOffset, value] : values)
+    result.add(value);
+  return result;
+}
+
+CriticalSearch::CriticalSearch(std::vector<double> betas,
+                               CriticalSearchSettings settings_)
+    : settings(settings_) {
+  std::sort(betas.begin(), betas.end());
+  betas.erase(std::unique(betas.begin(), betas.end()), betas.end());
+  for (double beta : betas) {
+    BetaPoint point;
+    point.beta = beta;
+    grid.push_back(point);
+  }
+  bracketLow = grid.front().beta;
+  bracketHigh = grid.back().beta;
+}
+
+void CriticalSearch::schedule(BetaPoint &point, int seeds,
+                              std::vector<std::pair<double, int>> &runs) {
+  for (int s = 0; s < seeds; ++s)
+    runs.emplace_back(point.beta, 1000 * point.scheduled++);
+}
+
+int CriticalSearch::runs() const {
+  int total = 0;
+  for (const BetaPoint &point : grid)
+    total += point.scheduled;
+  return total;
+}
+
+void CriticalSearch::addResult(double beta, int seedOffset, double value) {
+  for (BetaPoint &point : grid) {
+    if (point.beta == beta) {
+      point.values[seedOffset] = value;
+      return;
+    }
+  }
+}
+
+namespace {
+// Interval width on the log-β axis the grids are spaced on (linear from 0)
+double logWidth(double low, double high) {
+  return low > 0.0 ? std::log(high / low) : high - low;
+}
+} // namespace
+
+std::vector<std::pair<double, int>> CriticalSearch::nextRound() {
+  std::vector<std::pair<double, int>> runs;
+  if (stopped)
+    return runs;
+  if (roundCount == 0) {
+    for (BetaPoint &point : grid)
+      schedule(point, settings.initialSeeds, runs);
+    roundCount++;
+    return runs;
+  }
+  if (roundCount >= settings.maxRounds) {
+    stopped = true; // not converged
+    return runs;
+  }
+
+  // Slope of the mean over each interval, and its standard error
+  std::vector<RunningStats> stats;
+  for (const BetaPoint &point : grid)
+    stats.push_back(point.stats());
+  int intervals = static_cast<int>(grid.size()) - 1;
+  std::vector<double> slope(intervals), error(intervals);
+  int best = 0;
+  for (int k = 0; k < intervals; ++k) {
+    double width = logWidth(grid[k].beta, grid[k + 1].beta);
+    slope[k] = std::abs(stats[k + 1].mean() - stats[k].mean()) / width;
+    error[k] = std::hypot(stats[k].stderrOfMean(),
+                          stats[k + 1].stderrOfMean()) /
+               width;
+    if (slope[k] > slope[best])
+      best = k;
+  }
+  bracketLow = grid[best].beta;
+  bracketHigh = grid[best + 1].beta;
+  if (slope[best] == 0.0) {
+    stopped = true; // flat order parameter: nothing to locate
+    return runs;
+  }
+
+  // More seeds where the error bars leave the steepest interval in doubt
+  std::vector<bool> needsSeeds(grid.size(), false);
+  bool unresolved = std::abs(stats[best + 1].mean() - stats[best].mean()) <
+                    stats[best].stderrOfMean() + stats[best + 1].stderrOfMean();
+  if (unresolved)
+    needsSeeds[best] = needsSeeds[best + 1] = true;
+  for (int k = 0; k < intervals; ++k) {
+    if (k != best && slope[k] + error[k] >= slope[best] - error[best])
+      needsSeeds[best] = needsSeeds[best + 1] = needsSeeds[k] =
+          needsSeeds[k + 1] = true;
+  }
+  for (std::size_t p = 0; p < grid.size(); ++p) {
+    int room = settings.maxSeeds - grid[p].scheduled;
+    if (needsSeeds[p] && room > 0)
+      schedule(grid[p], std::min(settings.initialSeeds, room), runs);
+  }
+
+  if (runs.empty()) {
+    if (unresolved) {
+      stopped = true; // the change is within the noise even at maxSeeds
+      return runs;
+    }
+    if (bracketHigh - bracketLow <= settings.tolerance) {
+      stopped = true;
+      isConverged = true;
+      return runs;
+    }
+    // Refine: log-spaced points inside the bracket (linear from β = 0)
+    std::vector<BetaPoint> added;
+    for (int i = 1; i <= settings.refinePoints; ++i) {
+      double t = static_cast<double>(i) / (settings.refinePoints + 1);
+      BetaPoint point;
+      point.beta = bracketLow > 0.0
+                       ? bracketLow * std::pow(bracketHigh / bracketLow, t)
+                       : bracketLow + t * (bracketHigh - bracketLow);
+      added.push_back(point);
+    }
+    grid.insert(grid.begin() + best + 1, added.begin(), added.end());
+    for (int i = 0; i < settings.refinePoints; ++i)
+      schedule(grid[best + 1 + i], settings.initialSeeds, runs);
+  }
+
+  roundCount++;
+  return runs;
+}
+
+namespace {
+// The built-in campaign's β range, coarsely
+const std::vector<double> kCoarseBetas = {0.01, 0.03, 0.1, 0.3, 1.0, 3.0, 7.0};
+constexpr int kGridBetas = 19; // β values of the built-in campaign
+
+struct SearchTarget {
+  bool isBose;
+  std::string series;
+  int triangles;
+  CriticalSearch search;
+};
+} // namespace
+
+int runCriticalSearch(const ExperimentConfig &config,
+                      EnsembleAggregator &ensemble, Telemetry *telemetry) {
+  OrderParameter parameter = parseOrderParameter(config.adaptive);
+  CriticalSearchSettings settings;
+  settings.tolerance = config.betaTolerance;
+  settings.initialSeeds = config.adaptiveSeeds;
+  settings.maxSeeds = config.maxSeeds;
+  settings.refinePoints = config.refinePoints;
+  const std::vector<double> &betas =
+      config.betas.empty() ? kCoarseBetas : config.betas;
+
+  std::vector<SearchTarget> targets;
+  for (const std::string &name : config.statistics) {
+    std::string series = name;
+    if (config.dimension != 2)
+      series += "_d" + std::to_string(config.dimension);
+    if (!config.tag.empty())
+      series += "_" + config.tag;
+    for (int N : config.triangleTargets)
+      targets.push_back({name == "bose", series, N,
+                         CriticalSearch(betas, settings)});
+  }
+
+  int totalRuns = 0;
+  std::mutex resultMutex;
+  for (int round = 1;; ++round) {
+    SweepScheduler scheduler(config.threads);
+    int roundRuns = 0;
+    for (SearchTarget &target : targets) {
+      for (auto [beta, seedOffset] : target.search.nextRound()) {
+        SimulationJob job =
+            makeBetaSweepJobs(target.isBose, {beta}, {target.triangles},
+                              target.series, seedOffset, config.outputDir)
+                .front();
+        applyRunSettings(config, job);
+        // File names keep two decimals of β, which refined points share:
+        // the runs go to the summary only
+        job.metricsFile.clear();
+        job.edgesFile.clear();
+        job.curvatureFile.clear();
+        job.degreeHistogramFile.clear();
+        job.curvatureHistogramFile.clear();
+        job.hopsFile.clear();
+        job.spectralDensityFile.clear();
+        job.heatKernelFile.clear();
+        job.lowEigenvaluesFile.clear();
+        job.percolationFile.clear();
+
+        ensemble.expectRun(job.series, job.beta, job.targetTriangles,
+                           job.seed);
+        CriticalSearch *search = &target.search;
+        int offset = seedOffset;
+        JobProgress *progress = telemetry ? telemetry->addJob(job) : nullptr;
+        scheduler.addJob(job.targetTriangles, [=, &ensemble, &resultMutex]() {
+          MetricRow row = runJob(job, &ensemble, progress);
+          std::lock_guard<std::mutex> lock(resultMutex);
+          search->addResult(job.beta, offset,
+                            orderParameterValue(row, parameter));
+        }, describeJob(job));
+        roundRuns++;
+      }
+    }
+    if (roundRuns == 0)
+      break;
+
+    std::cout << "🔎 β_c round " << round << ": " << roundRuns << " runs on "
+              << scheduler.threads() << " threads\n";
+    std::vector<std::string> failures = scheduler.run();
+    totalRuns += roundRuns;
+    // The next round would be chosen from incomplete results
+    if (!failures.empty()) {
+      for (const std::string &failure : failures)
+        std::cerr << "❌ " << failure << "\n";
+      throw std::runtime_error("β_c search stopped in round " +
+                               std::to_string(round) + ": " +
+                               std::to_string(failures.size()) + " of " +
+                               std::to_string(roundRuns) + " runs failed");
+    }
+  }
+
+  fs::path dir = config.outputDir;
+  CsvWriter brackets((dir / "beta_c.csv").string());
+  brackets << "series,N,metric,beta_c,beta_low,beta_high,converged,rounds,"
+              "runs\n";
+  CsvWriter points((dir / "beta_c_points.csv").string());
+  points << "series,N,beta,seeds,mean,sem\n";
+  for (const SearchTarget &target : targets) {
+    const CriticalSearch &search = target.search;
+    brackets << target.series << ',' << target.triangles << ','
+             << config.adaptive << ',' << search.betaC() << ','
+             << search.low() << ',' << search.high() << ','
+             << (search.converged() ? 1 : 0) << ',' << search.rounds() << ','
+             << search.runs() << '\n';
+    for (const BetaPoint &point : search.points()) {
+      RunningStats stats = point.stats();
+      points << target.series << ',' << target.triangles << ',' << point.beta
+             << ',' << static_cast<int>(stats.count()) << ',' << stats.mean()
+             << ',' << stats.stderrOfMean() << '\n';
+    }
+
+    std::cout << "🧠 " << target.series << " N=" << target.triangles
+              << ": β_c ≈ " << search.betaC() << " in [" << search.low()
+              << ", " << search.high() << "] from " << config.adaptive
+              << (search.converged() ? "" : " (not converged)") << ", "
+              << search.runs() << " runs (the " << kGridBetas << "-β grid "
+              << "with " << config.maxSeeds << " seeds: "
+              << kGridBetas * config.maxSeeds << ")\n";
+  }
+  brackets.close();
+  points.close();
+  return totalRuns;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "ensemble.hpp"
+#include "experiment_config.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Telemetry;
+
+// Final-row metrics the β_c search can follow, named as in the summary
+enum class OrderParameter { MaxDistance, MaxDegree, EntropyRate };
+OrderParameter parseOrderParameter(const std::string &name); // or throws
+double orderParameterValue(const MetricRow &row, OrderParameter parameter);
+
+struct CriticalSearchSettings {
+  double tolerance = 0.05; // stop once the bracket is at most this wide
+  int initialSeeds = 3;    // seeds per new β, and per increase
+  int maxSeeds = 12;       // seeds per β at most
+  int refinePoints = 3;    // new β per refinement of the bracket
+  int maxRounds = 40;      // gives up (not converged) after this many
+};
+
+// Order parameter at one β, per seed offset
+struct BetaPoint {
+  double beta = 0.0;
+  int scheduled = 0;             // seeds requested so far
+  std::map<int, double> values;  // by seed offset, as results arrive
+  RunningStats stats() const;    // over values, folded in seed order
+};
+
+// Locates β_c for one (statistics, N) as the β interval of steepest change
+// of the order parameter, |Δ mean| / Δ ln β between neighboring grid points
+// (the finite-N crossover is smooth, so refined intervals must compete on
+// slope, not on total change). Every round either adds seeds or refines,
+// and stops once the bracket is within the tolerance:
+//   - seeds go to the endpoints of the steepest interval when their error
+//     bars (standard error of the mean) overlap, and to the endpoints of
+//     every interval whose slope ± error overlaps the steepest one's;
+//   - otherwise refinePoints β are inserted into the steepest interval
+//     (log-spaced), each with initialSeeds seeds.
+// If the steepest change stays within the error bars at maxSeeds, the
+// search stops unconverged. Decisions use the results in seed order only,
+// so they do not depend on the order in which parallel runs finish.
+class CriticalSearch {
+public:
+  CriticalSearch(std::vector<double> betas, CriticalSearchSettings settings);
+
+  // Runs of the next round as (β, seed offset), seed offsets 0, 1000, ...
+  // like --trials. Call once every result of the previous round was added;
+  // empty once the search has stopped.
+  std::vector<std::pair<double, int>> nextRound();
+  void addResult(double beta, int seedOffset, double value); // not locked
+
+  bool finished() const { return stopped; }
+  bool converged() const { return isConverged; }
+  double low() const { return bracketLow; } // current bracket of β_c
+  double high() const { return bracketHigh; }
+  double betaC() const { return 0.5 * (bracketLow + bracketHigh); }
+  int rounds() const { return roundCount; }
+  int runs() const;
+  const std::vector<BetaPoint> &points() const { return grid; }
+
+private:
+  CriticalSearchSettings settings;
+  std::vector<BetaPoint> grid; // sorted by β
+  int roundCount = 0;
+  bool stopped = false;
+  bool isConverged = false;
+  double bracketLow = 0.0;
+  double bracketHigh = 0.0;
+
+  static void schedule(BetaPoint &point, int seeds,
+                       std::vector<std::pair<double, int>> &runs);
+};
+
+// One search per (statistics, N) of the config, all advanced in lockstep
+// rounds whose runs share config.threads workers. Every run is added to the
+// ensemble (and to `telemetry` as it is scheduled); the brackets go to
+// <outputDir>/beta_c.csv and the points to beta_c_points.csv. Returns the
+// number of runs; if runs fail, their errors are printed and
+// std::runtime_error is thrown once the rest of the round has finished.
+int runCriticalSearch(const ExperimentConfig &config,
+                      EnsembleAggregator &ensemble,
+                      Telemetry *telemetry = nullptr);
@@ -0,0 +1,105 @@
+#include "csv_writer.hpp"
+#include "async_writer.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+CsvWriter::CsvWriter(const std::string &filename, bool append,
+                     std::size_t bufferSize)
+    : sink(std::make_shared<FileSink>(filename, append)),
+      buffer(AsyncWriter::takeBuffer(bufferSize < 64 ? 64 : bufferSize)) {}
+
+CsvWriter::~CsvWriter() {
+  try {
+    close();
+  } catch (...) {
+    // Destructors must not throw; call close() to see write errors
+  }
+}
+
+char *CsvWriter::reserve(std::size_t bytes) {
+  if (used + bytes > buffer.size())
+    handOff();
+  if (bytes > buffer.size())
+    buffer.resize(bytes);
+  return buffer.data() + used;
+}
+
+void CsvWriter::handOff(bool close) {
+  if (!sink)
+    throw std::runtime_error("CsvWriter: write after close");
+  if (!AsyncWriter::running()) {
+    sink->write(buffer.data(), used);
+    used = 0;
+    if (close)
+      sink->close();
+    return;
+  }
+  if (used == 0 && !close)
+    return;
+  // The filled buffer goes to the writer thread; we go on in a fresh one
+  std::size_t size = buffer.size();
+  buffer.resize(used);
+  AsyncWriter::submit(sink, std::move(buffer), close);
+  buffer = close ? std::vector<char>() : AsyncWriter::takeBuffer(size);
+  used = 0;
+}
+
+CsvWriter &CsvWriter::operator<<(std::string_view text) {
+  if (text.size() > buffer.size() / 2) { // large blocks bypass the buffer
+    handOff();
+    if (AsyncWriter::running())
+      AsyncWriter::submit(sink, std::vector<char>(text.begin(), text.end()));
+    else
+      sink->write(text.data(), text.size());
+    return *this;
+  }
+  std::memcpy(reserve(text.size()), text.data(), text.size());
+  used += text.size();
+  return *this;
+}
+
+CsvWriter &CsvWriter::operator<<(char c) {
+  *reserve(1) = c;
+  used += 1;
+  return *this;
+}
+
+CsvWriter &CsvWriter::operator<<(int value) {
+  return *this << static_cast<long long>(value);
+}
+
+CsvWriter &CsvWriter::operator<<(long long value) {
+  char *first = reserve(24);
+  auto result = std::to_chars(first, first + 24, value);
+  used += result.ptr - first;
+  return *this;
+}
+
+CsvWriter &CsvWriter::operator<<(double value) {
+  char *first = reserve(32);
+  auto result =
+      std::to_chars(first, first + 32, value, std::chars_format::general, 6);
+  used += result.ptr - first;
+  return *this;
+}
+
+void CsvWriter::flush() {
+  if (!sink)
+    return;
+  handOff();
+  AsyncWriter::wait(*sink);
+}
+
+void CsvWriter::close() {
+  if (!sink)
+    return;
+  try {
+    handOff(true);
+  } catch (...) {
+    sink.reset(); // closed (or closing) either way
+    throw;
+  }
+  sink.reset();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Buffered CSV output: numbers are formatted with std::to_chars into a large
+// buffer that is written to the file in big chunks. Doubles use the same
+// "%g" / precision 6 format as `std::ostream << double`, so files are
+// byte-identical to the iostream exporters they replace. While AsyncWriter
+// runs, full buffers go to its thread instead of the file; names ending in
+// ".gz" are gzip-compressed (FileSink).
+class FileSink;
+
+class CsvWriter {
+public:
+  explicit CsvWriter(const std::string &filename, bool append = false,
+                     std::size_t bufferSize = 1 << 20);
+  ~CsvWriter(); // flushes and closes
+
+  CsvWriter(const CsvWriter &) = delete;
+  CsvWriter &operator=(const CsvWriter &) = delete;
+
+  CsvWriter &operator<<(std::string_view text);
+  CsvWriter &operator<<(char c);
+  CsvWriter &operator<<(int value);
+  CsvWriter &operator<<(long long value);
+  CsvWriter &operator<<(double value);
+
+  // Hands the buffer to the OS, and waits for AsyncWriter to do so
+  void flush();
+  // Flushes and closes; throws std::runtime_error on failure. With
+  // AsyncWriter running it returns at once, and failures of the queued
+  // writes are reported by AsyncWriter::stop().
+  void close();
+
+private:
+  std::shared_ptr<FileSink> sink;
+  std::vector<char> buffer;
+  std::size_t used = 0;
+
+  char *reserve(std::size_t bytes); // room for `bytes` more characters
+  void handOff(bool close = false); // the buffer to the sink or the writer
+};
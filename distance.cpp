@@ -0,0 +1,182 @@
+#include "distance.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+// Beamer's switching thresholds: go bottom-up once the frontier has more
+// than 1/α of the unexplored edges, back top-down below N/β frontier nodes
+constexpr long long kAlpha = 14;
+constexpr long long kBeta = 24;
+
+int lowestBit(std::uint64_t word) { // word != 0
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, word);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(word);
+#endif
+}
+
+void setBit(std::vector<std::uint64_t> &bits, int i) {
+  bits[i >> 6] |= std::uint64_t(1) << (i & 63);
+}
+
+bool testBit(const std::vector<std::uint64_t> &bits, int i) {
+  return (bits[i >> 6] >> (i & 63)) & 1;
+}
+} // namespace
+
+BreadthFirstSearch::BreadthFirstSearch(const DistanceGraph &graph)
+    : g(graph) {}
+
+const std::vector<int> &
+BreadthFirstSearch::run(const std::vector<int> &sources) {
+  int n = std::max(g.size(), 0);
+  dist.assign(n, -1);
+  levels.clear();
+  frontier.clear();
+  visited.assign((n + 63) / 64, 0);
+  if (n % 64 != 0)
+    visited.back() |= ~std::uint64_t(0) << (n % 64); // padding: never visit
+
+  long long frontierEdges = 0;
+  for (int s : sources) {
+    if (s < 0 || s >= n || dist[s] >= 0)
+      continue;
+    dist[s] = 0;
+    setBit(visited, s);
+    frontier.push_back(s);
+    frontierEdges += g.degree(s);
+  }
+
+  long long unexploredEdges =
+      static_cast<long long>(g.targets.size()) - frontierEdges;
+  bool bottom = false;
+  for (int depth = 0; !frontier.empty(); ++depth) {
+    levels.push_back(static_cast<long long>(frontier.size()));
+    if (!bottom && frontierEdges > unexploredEdges / kAlpha)
+      bottom = true;
+    else if (bottom && static_cast<long long>(frontier.size()) < n / kBeta)
+      bottom = false;
+
+    frontierEdges = bottom ? bottomUp(depth) : topDown(depth);
+    unexploredEdges -= frontierEdges;
+    frontier.swap(next);
+  }
+  return dist;
+}
+
+long long BreadthFirstSearch::topDown(int depth) {
+  next.clear();
+  long long edges = 0;
+  for (int u : frontier) {
+    for (int k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+      int v = g.targets[k];
+      if (dist[v] < 0) {
+        dist[v] = depth + 1;
+        setBit(visited, v);
+        next.push_back(v);
+        edges += g.degree(v);
+      }
+    }
+  }
+  return edges;
+}
+
+long long BreadthFirstSearch::bottomUp(int depth) {
+  inFrontier.assign(visited.size(), 0);
+  for (int u : frontier)
+    setBit(inFrontier, u);
+
+  next.clear();
+  long long edges = 0;
+  for (std::size_t w = 0; w < visited.size(); ++w) {
+    // Only the unvisited nodes of this word look for a parent
+    for (std::uint64_t open = ~visited[w]; open != 0; open &= open - 1) {
+      int v = static_cast<int>(w * 64) + lowestBit(open);
+      for (int k = g.offsets[v]; k < g.offsets[v + 1]; ++k) {
+        if (testBit(inFrontier, g.targets[k])) {
+          dist[v] = depth + 1;
+          next.push_back(v);
+          edges += g.degree(v);
+          break;
+        }
+      }
+    }
+  }
+  for (int v : next) // after the scan: new nodes are no parents this level
+    setBit(visited, v);
+  return edges;
+}
+
+PathLengthStats PathLengths::compute(const DistanceGraph &graph, int samples,
+                                     int threads, unsigned seed) {
+  PathLengthStats stats;
+  int n = std::max(graph.size(), 0);
+  if (n == 0)
+    return stats;
+
+  // Partial Fisher-Yates: the first `samples` entries are distinct roots
+  std::vector<int> roots(n);
+  std::iota(roots.begin(), roots.end(), 0);
+  stats.exact = samples <= 0 || samples >= n;
+  if (!stats.exact) {
+    std::mt19937 rng(seed);
+    for (int k = 0; k < samples; ++k) {
+      std::uniform_int_distribution<int> pick(k, n - 1);
+      std::swap(roots[k], roots[pick(rng)]);
+    }
+    roots.resize(samples);
+  }
+  stats.sources = static_cast<int>(roots.size());
+  threads = std::max(1, std::min(threads, stats.sources));
+
+  std::vector<std::vector<long long>> pairs(threads);
+  std::atomic<int> nextRoot{0};
+  auto worker = [&](int t) {
+    BreadthFirstSearch bfs(graph);
+    for (int r = nextRoot++; r < stats.sources; r = nextRoot++) {
+      bfs.run({roots[r]});
+      const std::vector<long long> &levels = bfs.levelSizes();
+      if (pairs[t].size() < levels.size())
+        pairs[t].resize(levels.size(), 0);
+      for (std::size_t d = 0; d < levels.size(); ++d)
+        pairs[t][d] += levels[d];
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(worker, t);
+  worker(0);
+  for (std::thread &t : pool)
+    t.join();
+
+  // Integer sums: the same whichever thread ran which root
+  for (const std::vector<long long> &local : pairs) {
+    if (stats.pairs.size() < local.size())
+      stats.pairs.resize(local.size(), 0);
+    for (std::size_t d = 0; d < local.size(); ++d)
+      stats.pairs[d] += local[d];
+  }
+
+  long long count = 0;
+  long long total = 0;
+  for (std::size_t d = 1; d < stats.pairs.size(); ++d) {
+    count += stats.pairs[d];
+    total += static_cast<long long>(d) * stats.pairs[d];
+  }
+  if (count > 0)
+    stats.averagePathLength = static_cast<double>(total) / count;
+  stats.diameter = std::max(0, static_cast<int>(stats.pairs.size()) - 1);
+  return stats;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Unweighted undirected graph in CSR form for the distance computations
+struct DistanceGraph {
+  std::vector<int> offsets; // neighbors of i: [offsets[i], offsets[i+1])
+  std::vector<int> targets;
+
+  int size() const { return static_cast<int>(offsets.size()) - 1; }
+  int degree(int i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+// Multi-source BFS over flat arrays, direction-optimizing (Beamer et al.
+// 2012): levels expand top-down from a frontier queue while the frontier is
+// small, and bottom-up (every unvisited node looks for a parent in a
+// frontier bitset) once the frontier's edges outnumber the unexplored ones,
+// which happens within a few hops of the hubs of Bose networks. Distances do
+// not depend on the direction taken. The workspace is reused between runs.
+class BreadthFirstSearch {
+public:
+  explicit BreadthFirstSearch(const DistanceGraph &graph);
+
+  // Hop distance of every node from the nearest source, -1 if unreachable
+  const std::vector<int> &run(const std::vector<int> &sources);
+
+  const std::vector<int> &distances() const { return dist; }
+  // levelSizes()[d] = nodes at distance d in the last run
+  const std::vector<long long> &levelSizes() const { return levels; }
+  int eccentricity() const { return static_cast<int>(levels.size()) - 1; }
+
+private:
+  const DistanceGraph &g;
+  std::vector<int> dist;
+  std::vector<long long> levels;
+  std::vector<int> frontier, next;       // top-down queues
+  std::vector<std::uint64_t> inFrontier; // bottom-up frontier bitset
+  std::vector<std::uint64_t> visited;
+
+  long long topDown(int depth);  // returns Σ degree over the new frontier
+  long long bottomUp(int depth); // same
+};
+
+struct PathLengthStats {
+  int sources = 0;             // BFS roots used
+  bool exact = false;          // every node was a root
+  std::vector<long long> pairs; // pairs[d] = (root, target) pairs at distance d
+  double averagePathLength = 0.0; // mean over pairs with d >= 1
+  int diameter = 0; // largest distance found; a lower bound unless exact
+};
+
+// Shortest-path statistics from `samples` distinct random roots (all nodes
+// if samples <= 0 or >= N), one BFS per root spread over threads. The roots
+// depend only on (samples, seed) and the per-thread counts are integers, so
+// the result does not depend on the number of threads.
+class PathLengths {
+public:
+  static PathLengthStats compute(const DistanceGraph &graph, int samples = 0,
+                                 int threads = 1, unsigned seed = 42);
+};
@@ -0,0 +1,124 @@
+#include "energy_class_sampler.hpp"
+
+#include <cmath>
+
+EnergyClassSampler::EnergyClassSampler(Network &network) : net(network) {
+  rebuild();
+  net.addObserver(this);
+}
+
+EnergyClassSampler::~EnergyClassSampler() { net.removeObserver(this); }
+
+void EnergyClassSampler::rebuild() {
+  levels.clear();
+  slotOf.clear();
+  minEnergy = 0;
+
+  slotOf.reserve(net.numLinks());
+  for (int k = 0; k < net.numLinks(); ++k)
+    append(net.getLink(k), k);
+}
+
+long long EnergyClassSampler::multiplicity(int numTriangles) const {
+  return numTriangles >= net.m ? 0 : 1 + numTriangles;
+}
+
+EnergyClassSampler::Level &EnergyClassSampler::level(int energy) {
+  if (levels.empty()) {
+    minEnergy = energy;
+  } else if (energy < minEnergy) {
+    levels.insert(levels.begin(), minEnergy - energy, Level());
+    minEnergy = energy;
+    // ε0 moved: every cached factor is relative to it
+    for (int k = 0; k < (int)levels.size(); ++k)
+      levels[k].factor = std::exp(-net.beta * k);
+  }
+
+  int k = energy - minEnergy;
+  while (k >= (int)levels.size()) {
+    levels.emplace_back();
+    levels.back().factor = std::exp(-net.beta * (levels.size() - 1));
+  }
+  return levels[k];
+}
+
+void EnergyClassSampler::append(const Link &link, int linkIndex) {
+  Level &l = level(link.energy);
+  long long w = multiplicity(link.numTriangles);
+
+  // Fenwick append: node p covers (p - lowbit(p), p], i.e. w plus the
+  // nodes of the slots just below it
+  int p = static_cast<int>(l.links.size()) + 1;
+  if (l.tree.empty())
+    l.tree.push_back(0); // index 0 is unused
+  long long sum = w;
+  for (int q = p - 1; q > p - (p & -p); q -= q & -q)
+    sum += l.tree[q];
+  l.tree.push_back(sum);
+
+  l.links.push_back(linkIndex);
+  l.M += w;
+  slotOf.push_back(p - 1);
+}
+
+void EnergyClassSampler::addWeight(Level &l, int slot, long long delta) {
+  for (int p = slot + 1; p < (int)l.tree.size(); p += p & -p)
+    l.tree[p] += delta;
+  l.M += delta;
+}
+
+void EnergyClassSampler::onLinkUpdated(const Network &network,
+                                       const Link &link, int oldNumTriangles) {
+  int k = network.linkIndex(link);
+  if (oldNumTriangles == 0) {
+    append(link, k); // links are created in index order
+    return;
+  }
+
+  long long delta =
+      multiplicity(link.numTriangles) - multiplicity(oldNumTriangles);
+  if (delta != 0)
+    addWeight(level(link.energy), slotOf[k], delta);
+}
+
+double EnergyClassSampler::total() const {
+  double Z = 0.0;
+  for (const Level &l : levels)
+    Z += l.factor * l.M;
+  return Z;
+}
+
+int EnergyClassSampler::sample(std::mt19937 &rng) const {
+  // Stage 1: energy level, P(ε) ∝ e^{-β(ε-ε0)} M_ε
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double u = uniform(rng) * total();
+
+  int chosen = -1;
+  for (int k = 0; k < (int)levels.size(); ++k) {
+    double w = levels[k].factor * levels[k].M;
+    if (w <= 0.0)
+      continue;
+    chosen = k; // rounding can leave u just past the last level
+    if (u < w)
+      break;
+    u -= w;
+  }
+  const Level &l = levels[chosen];
+
+  // Stage 2: link within the level, P = (1+n) / M_ε, exact in integers
+  std::uniform_int_distribution<long long> pick(0, l.M - 1);
+  long long r = pick(rng);
+
+  int size = static_cast<int>(l.links.size());
+  int pos = 0;
+  int step = 1;
+  while (2 * step <= size)
+    step *= 2;
+  for (; step > 0; step /= 2) {
+    if (pos + step <= size && l.tree[pos + step] <= r) {
+      pos += step;
+      r -= l.tree[pos];
+    }
+  }
+  return l.links[pos]; // first slot whose prefix sum exceeds the draw
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "network.hpp"
+#include "network_observer.hpp"
+
+#include <random>
+#include <vector>
+
+// Two-stage growth sampler. Link energies are small integers, so links are
+// grouped by energy level ε and e^{-β(ε-ε0)} is computed once per level
+// (ε0 = lowest level seen). A draw first picks a level with probability
+// ∝ e^{-βε} M_ε, where M_ε = Σ (1+n) over its unsaturated links is an exact
+// integer, then a link inside it with probability (1+n) / M_ε from an
+// integer Fenwick tree, so the second stage involves no rounding at all.
+//
+// Draws follow the same distribution as Network::sampler but consume the
+// rng differently, so runs are not bit-identical across the two samplers.
+class EnergyClassSampler : public NetworkObserver {
+public:
+  explicit EnergyClassSampler(Network &network); // attaches to network
+  ~EnergyClassSampler() override;                // detaches from network
+
+  EnergyClassSampler(const EnergyClassSampler &) = delete;
+  EnergyClassSampler &operator=(const EnergyClassSampler &) = delete;
+
+  // Recomputes every level from the current links (same slots as growth)
+  void rebuild();
+
+  double total() const; // Z e^{βε0}; growth is possible iff > 0
+  int numLevels() const { return static_cast<int>(levels.size()); }
+
+  // Draws a link index with probability e^{-βε}(1+n) / Z
+  int sample(std::mt19937 &rng) const;
+
+  void onLinkUpdated(const Network &network, const Link &link,
+                     int oldNumTriangles) override;
+
+private:
+  struct Level {
+    std::vector<long long> tree; // Fenwick tree over slot weights, 1-based
+    std::vector<int> links;      // links[s] = link index held by slot s
+    long long M = 0;             // Σ (1+n) over unsaturated links
+    double factor = 0.0;         // e^{-β(ε - ε0)}
+  };
+
+  Network &net;
+  int minEnergy = 0;         // ε0, energy of levels[0]
+  std::vector<Level> levels; // levels[ε - ε0]
+  std::vector<int> slotOf;   // slotOf[k] = slot of link k in its level
+
+  Level &level(int energy); // creates missing levels on demand
+  void append(const Link &link, int linkIndex);
+  void addWeight(Level &l, int slot, long long delta);
+  long long multiplicity(int numTriangles) const; // 1+n, 0 once saturated
+};
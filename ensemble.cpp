@@ -0,0 +1,212 @@
+#include "ensemble.hpp"
+#include "csv_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+void RunningStats::add(double x) {
+  n++;
+  double delta = x - mu;
+  mu += delta / n;
+  m2 += delta * (x - mu);
+  lo = std::min(lo, x);
+  hi = std::max(hi, x);
+}
+
+double RunningStats::variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+
+double RunningStats::stddev() const { return std::sqrt(variance()); }
+
+double RunningStats::stderrOfMean() const {
+  return n > 0 ? stddev() / std::sqrt(static_cast<double>(n)) : 0.0;
+}
+
+namespace {
+constexpr int kMetrics = 10;
+const char *kMetricNames[kMetrics] = {
+    "max_distance",       "k_max",
+    "entropy",            "avg_clustering",
+    "modularity",         "avg_path_length",
+    "diameter",           "spectral_dimension",
+    "percolation_random", "percolation_degree"};
+
+std::array<double, kMetrics> values(const MetricRow &row) {
+  return {static_cast<double>(row.maxDistance), static_cast<double>(row.kMax),
+          row.entropy, row.avgClustering, row.modularity, row.avgPathLength,
+          row.diameter, row.spectralDimension, row.percolationRandom,
+          row.percolationDegree};
+}
+
+// Linear interpolation between order statistics (numpy's default)
+double quantile(const std::vector<double> &sorted, double q) {
+  double position = q * (sorted.size() - 1);
+  std::size_t below = static_cast<std::size_t>(position);
+  if (below + 1 >= sorted.size())
+    return sorted.back();
+  double fraction = position - below;
+  return sorted[below] + fraction * (sorted[below + 1] - sorted[below]);
+}
+} // namespace
+
+void EnsembleAggregator::fold(std::vector<Cell> &cells,
+                              const std::vector<MetricRow> &rows) const {
+  // The run's (step, metric, value) in cell order
+  struct Entry {
+    long long step;
+    int metric;
+    double value;
+  };
+  std::vector<Entry> entries;
+  for (const MetricRow &row : rows) {
+    std::array<double, kMetrics> x = values(row);
+    for (int m = 0; m < kMetrics; ++m)
+      if (!std::isnan(x[m]))
+        entries.push_back({row.step, m, x[m]});
+  }
+  auto before = [](long long step, int metric, const auto &other) {
+    return step < other.step || (step == other.step && metric < other.metric);
+  };
+  std::stable_sort(entries.begin(), entries.end(),
+                   [&](const Entry &a, const Entry &b) {
+                     return before(a.step, a.metric, b);
+                   });
+
+  // Runs of a group log the same steps, so usually every cell exists and
+  // is updated in place; otherwise the new cells are merged in
+  std::vector<Cell> merged;
+  bool inPlace = true;
+  std::size_t c = 0;
+  for (const Entry &e : entries) {
+    while (c < cells.size() && before(cells[c].step, cells[c].metric, e))
+      c++;
+    if (c == cells.size() || cells[c].step != e.step ||
+        cells[c].metric != e.metric) {
+      inPlace = false;
+      break;
+    }
+    c++;
+  }
+  if (!inPlace)
+    merged.reserve(cells.size() + entries.size());
+
+  c = 0;
+  for (const Entry &e : entries) {
+    while (c < cells.size() && before(cells[c].step, cells[c].metric, e)) {
+      if (!inPlace)
+        merged.push_back(std::move(cells[c]));
+      c++;
+    }
+    Cell *cell;
+    if (c < cells.size() && cells[c].step == e.step &&
+        cells[c].metric == e.metric) {
+      if (inPlace) {
+        cell = &cells[c];
+      } else {
+        merged.push_back(std::move(cells[c]));
+        cell = &merged.back();
+      }
+      c++;
+    } else if (!merged.empty() && merged.back().step == e.step &&
+               merged.back().metric == e.metric) {
+      cell = &merged.back(); // a row logged twice by the run
+    } else {
+      merged.push_back(Cell{e.step, e.metric, RunningStats(), {}});
+      cell = &merged.back();
+    }
+    cell->stats.add(e.value);
+    if (withQuantiles)
+      cell->samples.push_back(e.value);
+  }
+  if (!inPlace) {
+    for (; c < cells.size(); ++c)
+      merged.push_back(std::move(cells[c]));
+    cells.swap(merged);
+  }
+}
+
+void EnsembleAggregator::expectRun(const std::string &series, double beta,
+                                   int triangles, int seed) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Group &group = groups[GroupKey(series, beta, triangles)];
+  if (!group.folded.count(seed) && !group.early.count(seed))
+    group.pending.insert(seed);
+}
+
+void EnsembleAggregator::addRun(const std::string &series, double beta,
+                                int triangles, int seed,
+                                std::vector<MetricRow> rows) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Group &group = groups[GroupKey(series, beta, triangles)];
+  if (group.folded.count(seed) || group.early.count(seed))
+    return;
+  if (group.pending.empty() || *group.pending.begin() != seed) {
+    group.early[seed] = std::move(rows); // a smaller seed is still running
+    return;
+  }
+  fold(group.cells, rows);
+  group.folded.insert(seed);
+  group.pending.erase(group.pending.begin());
+
+  // Runs that were waiting for this one
+  while (!group.pending.empty()) {
+    auto next = group.early.find(*group.pending.begin());
+    if (next == group.early.end())
+      break;
+    fold(group.cells, next->second);
+    group.folded.insert(next->first);
+    group.early.erase(next);
+    group.pending.erase(group.pending.begin());
+  }
+}
+
+std::size_t EnsembleAggregator::runs() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::size_t total = 0;
+  for (const auto &[key, group] : groups)
+    total += group.folded.size() + group.early.size();
+  return total;
+}
+
+void EnsembleAggregator::writeSummary(const std::string &filename) const {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  CsvWriter out(filename);
+  out << "series,beta,N,step,metric,count,mean,std,sem,min,max";
+  if (withQuantiles)
+    out << ",p05,p25,p50,p75,p95";
+  out << '\n';
+
+  for (const auto &[key, group] : groups) {
+    const auto &[series, beta, triangles] = key;
+
+    // Runs still held back (not announced, or behind a failed run) are
+    // folded into a copy, in seed order, so the summary can be rewritten
+    std::vector<Cell> copy;
+    const std::vector<Cell> *cells = &group.cells;
+    if (!group.early.empty()) {
+      copy = group.cells;
+      for (const auto &[seed, rows] : group.early)
+        fold(copy, rows);
+      cells = &copy;
+    }
+
+    for (const Cell &cell : *cells) {
+      const RunningStats &s = cell.stats;
+      out << series << ',' << beta << ',' << triangles << ',' << cell.step
+          << ',' << kMetricNames[cell.metric] << ','
+          << static_cast<long long>(s.count()) << ',' << s.mean() << ','
+          << s.stddev() << ',' << s.stderrOfMean() << ',' << s.min() << ','
+          << s.max();
+      if (withQuantiles) {
+        std::vector<double> sorted = cell.samples;
+        std::sort(sorted.begin(), sorted.end());
+        for (double q : {0.05, 0.25, 0.5, 0.75, 0.95})
+          out << ',' << quantile(sorted, q);
+      }
+      out << '\n';
+    }
+  }
+
+  out.close();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// One row of a run's metric time series (the metrics CSV). avg_clustering,
+// modularity, the path lengths and the spectral dimension are only known for
+// the final row; NaN elsewhere.
+struct MetricRow {
+  long long step = 0;
+  int maxDistance = 0;
+  int kMax = 0;
+  double entropy = 0.0;
+  double avgClustering = std::numeric_limits<double>::quiet_NaN();
+  double modularity = std::numeric_limits<double>::quiet_NaN();
+  double avgPathLength = std::numeric_limits<double>::quiet_NaN();
+  double diameter = std::numeric_limits<double>::quiet_NaN();
+  double spectralDimension = std::numeric_limits<double>::quiet_NaN();
+  // Removed fraction at which the largest component collapses (Percolation)
+  double percolationRandom = std::numeric_limits<double>::quiet_NaN();
+  double percolationDegree = std::numeric_limits<double>::quiet_NaN();
+};
+
+// Welford running mean / variance, with min and max
+class RunningStats {
+public:
+  void add(double x);
+
+  long long count() const { return n; }
+  double mean() const { return mu; }
+  double variance() const; // sample variance (n - 1), 0 for n < 2
+  double stddev() const;
+  double stderrOfMean() const;
+  double min() const { return lo; }
+  double max() const { return hi; }
+
+private:
+  long long n = 0;
+  double mu = 0.0;
+  double m2 = 0.0; // Σ (x - mean)²
+  double lo = std::numeric_limits<double>::infinity();
+  double hi = -std::numeric_limits<double>::infinity();
+};
+
+// Reduces the metric series of runs across seeds as they arrive, keyed by
+// (series, β, N, step): one RunningStats per step and metric, so memory
+// does not grow with the number of runs (raw values are kept only for
+// quantiles). Runs arrive from worker threads in any order; to fold them in
+// seed order, whatever the number of threads, each group folds the runs
+// announced with expectRun() in ascending seed order and holds back only
+// those that arrive ahead of the smallest seed still pending. Runs that
+// were not announced, or wait behind a run that never came (it failed), are
+// folded in seed order when the summary is written.
+class EnsembleAggregator {
+public:
+  explicit EnsembleAggregator(bool quantiles = false)
+      : withQuantiles(quantiles) {}
+
+  // Thread-safe. Announces a run addRun() will receive, before any run of
+  // its group arrives.
+  void expectRun(const std::string &series, double beta, int triangles,
+                 int seed);
+  // Thread-safe. `series` is the output prefix (e.g. "fermi_time"). A seed
+  // is counted once per group; repeated runs of it are ignored.
+  void addRun(const std::string &series, double beta, int triangles,
+              int seed, std::vector<MetricRow> rows);
+
+  std::size_t runs() const;
+
+  // series,beta,N,step,metric,count,mean,std,sem,min,max
+  // [,p05,p25,p50,p75,p95] — one row per key and metric; std is the sample
+  // standard deviation over seeds, sem = std / sqrt(count)
+  void writeSummary(const std::string &filename) const;
+
+private:
+  using GroupKey = std::tuple<std::string, double, int>; // series, β, N
+
+  // Statistics of one (step, metric) over the runs folded so far
+  struct Cell {
+    long long step;
+    int metric;
+    RunningStats stats;
+    std::vector<double> samples; // only kept for quantiles
+  };
+
+  struct Group {
+    std::vector<Cell> cells;   // sorted by (step, metric)
+    std::set<int> pending;     // announced seeds not folded yet
+    std::set<int> folded;      // seeds in cells
+    std::map<int, std::vector<MetricRow>> early; // arrived out of order
+  };
+
+  bool withQuantiles;
+  mutable std::mutex mutex;
+  std::map<GroupKey, Group> groups;
+
+  void fold(std::vector<Cell> &cells, const std::vector<MetricRow> &rows) const;
+};
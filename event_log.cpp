@@ -0,0 +1,268 @@
+#include "event_log.hpp"
+#include "async_writer.hpp"
+#include "growth_policies.hpp"
+#include "network.hpp"
+
+#include <cstring> // for memcpy, memcmp
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+// File layout (native endianness, checked on load):
+//   FileHeader
+//   per step: varint (links before the step - 1 - link), varint zigzag(ω)
+
+namespace {
+constexpr char kMagic[8] = {'Q', 'N', 'E', 'T', 'E', 'L', 'O', 'G'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kEndianTag = 0x01020304;
+constexpr std::size_t kBufferBytes = 1 << 20; // written in chunks this big
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endianTag;
+  double beta;
+  std::int32_t m;
+  std::int32_t quadraticEnergy;
+  std::int32_t seed;
+  std::int32_t seedEnergies[3];
+};
+static_assert(sizeof(FileHeader) == 48, "event log header must stay packed");
+
+void putVarint(std::vector<char> &out, std::uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// False if the varint runs past `end` (a torn last step)
+bool getVarint(const unsigned char *&cursor, const unsigned char *end,
+               std::uint32_t &value) {
+  value = 0;
+  for (int shift = 0; cursor < end && shift < 35; shift += 7) {
+    unsigned char byte = *cursor++;
+    value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+std::uint32_t zigzag(int value) {
+  return (static_cast<std::uint32_t>(value) << 1) ^
+         static_cast<std::uint32_t>(value >> 31);
+}
+
+int unzigzag(std::uint32_t value) {
+  return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+std::vector<unsigned char> readFile(const std::string &filename) {
+  std::ifstream in(filename, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Cannot open event log " + filename);
+  return std::vector<unsigned char>(std::istreambuf_iterator<char>(in),
+                                    std::istreambuf_iterator<char>());
+}
+
+FileHeader readHeader(const std::vector<unsigned char> &bytes,
+                      const std::string &filename) {
+  FileHeader header;
+  if (bytes.size() < sizeof(header))
+    throw std::runtime_error("Truncated event log " + filename);
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("Not an event log: " + filename);
+  if (header.version != kVersion)
+    throw std::runtime_error("Unsupported event log version in " + filename);
+  if (header.endianTag != kEndianTag)
+    throw std::runtime_error("Event log written on a different byte order: " +
+                             filename);
+  return header;
+}
+
+// Decodes steps from `cursor` until the data or `maxSteps` ends; calls
+// step(link, ω) for each and returns where the last complete step ended
+template <class OnStep>
+const unsigned char *decodeSteps(const unsigned char *cursor,
+                                 const unsigned char *end,
+                                 std::uint64_t maxSteps,
+                                 const std::string &filename,
+                                 OnStep &&step) {
+  std::int64_t links = 3;
+  for (std::uint64_t s = 0; s < maxSteps && cursor < end; ++s) {
+    const unsigned char *start = cursor;
+    std::uint32_t back, energy;
+    if (!getVarint(cursor, end, back) || !getVarint(cursor, end, energy))
+      return start;
+    if (back >= links)
+      throw std::runtime_error("Corrupt event log (bad link): " + filename);
+    step(static_cast<int>(links - 1 - back), unzigzag(energy));
+    links += 2;
+  }
+  return cursor;
+}
+} // namespace
+
+EventLogWriter::EventLogWriter(const std::string &filename,
+                               const Network &net, bool quadraticEnergy,
+                               int seed)
+    : path(filename) {
+  if (net.numNodes() != 3 || net.numTriangles() != 1)
+    throw std::invalid_argument("An event log starts at the seed triangle");
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endianTag = kEndianTag;
+  header.beta = net.beta;
+  header.m = net.m;
+  header.quadraticEnergy = quadraticEnergy ? 1 : 0;
+  header.seed = seed;
+  for (int node = 0; node < 3; ++node)
+    header.seedEnergies[node] = net.nodeEnergy(node);
+
+  sink = std::make_shared<FileSink>(path, false);
+  const char *bytes = reinterpret_cast<const char *>(&header);
+  buffer.assign(bytes, bytes + sizeof(header));
+}
+
+EventLogWriter::EventLogWriter(const std::string &filename,
+                               std::uint64_t steps)
+    : path(filename) {
+  std::vector<unsigned char> bytes = readFile(path);
+  readHeader(bytes, path);
+  const unsigned char *end =
+      decodeSteps(bytes.data() + sizeof(FileHeader),
+                  bytes.data() + bytes.size(), steps, path,
+                  [this](int, int) { stepCount++; });
+  if (stepCount != steps)
+    throw std::runtime_error("Event log " + path + " ends before step " +
+                             std::to_string(steps));
+  links = 3 + 2 * static_cast<std::int64_t>(steps);
+
+  fs::resize_file(path, static_cast<std::uintmax_t>(end - bytes.data()));
+  sink = std::make_shared<FileSink>(path, true);
+}
+
+EventLogWriter::~EventLogWriter() {
+  try {
+    close();
+  } catch (const std::exception &) {
+    // Destructors must not throw; call close() to see write errors
+  }
+}
+
+void EventLogWriter::append(int link, int energy) {
+  putVarint(buffer, static_cast<std::uint32_t>(links - 1 - link));
+  putVarint(buffer, zigzag(energy));
+  links += 2;
+  stepCount++;
+  if (buffer.size() >= kBufferBytes)
+    writeBuffer();
+}
+
+void EventLogWriter::writeBuffer(bool close) {
+  if (!sink)
+    throw std::runtime_error("Event log " + path + " is closed");
+  if (buffer.empty() && !close)
+    return;
+  AsyncWriter::submit(sink, std::move(buffer), close);
+  buffer = AsyncWriter::takeBuffer(0);
+  buffer.reserve(kBufferBytes + 16);
+}
+
+void EventLogWriter::flush() {
+  writeBuffer();
+  AsyncWriter::wait(*sink);
+}
+
+void EventLogWriter::close() {
+  if (!sink)
+    return;
+  try {
+    writeBuffer(true);
+  } catch (...) {
+    sink.reset(); // closed (or closing) either way
+    throw;
+  }
+  sink.reset();
+}
+
+EventLog::EventLog(const std::string &filename) {
+  std::vector<unsigned char> bytes = readFile(filename);
+  FileHeader header = readHeader(bytes, filename);
+  info.beta = header.beta;
+  info.m = header.m;
+  info.quadraticEnergy = header.quadraticEnergy != 0;
+  info.seed = header.seed;
+  for (int node = 0; node < 3; ++node)
+    info.seedEnergies[node] = header.seedEnergies[node];
+
+  // Most steps take 4-5 bytes
+  std::size_t expected = (bytes.size() - sizeof(header)) / 4;
+  linkIndices.reserve(expected);
+  energies.reserve(expected);
+  decodeSteps(bytes.data() + sizeof(header), bytes.data() + bytes.size(),
+              UINT64_MAX, filename, [this](int link, int energy) {
+                linkIndices.push_back(link);
+                energies.push_back(energy);
+              });
+}
+
+std::function<double(int, int)> EventLog::energyFunction() const {
+  if (info.quadraticEnergy)
+    return QuadraticEnergy();
+  return LinearEnergy();
+}
+
+void EventLog::start(Network &net) const {
+  if (net.numNodes() != 0)
+    throw std::invalid_argument("EventLog::start needs an empty network");
+  for (int node = 0; node < 3; ++node)
+    net.addNode(info.seedEnergies[node]);
+  net.addTriangle(0, 1, 2);
+}
+
+namespace {
+template <class Statistics, class Energy>
+void applySteps(Network &net, const std::vector<int> &links,
+                const std::vector<int> &energies, int from, int to) {
+  for (int s = from; s < to; ++s) {
+    int node = net.addNode(energies[s]);
+    net.attachTriangle(links[s], node, Statistics{}, Energy{});
+  }
+}
+} // namespace
+
+void EventLog::replay(Network &net, int toStep) const {
+  int from = net.numTriangles() - 1;
+  if (from < 0 || toStep > steps())
+    throw std::out_of_range("EventLog::replay: step out of range");
+
+  // The compiled policies of the growth kernels where they apply
+  bool quadratic = info.quadraticEnergy;
+  if (net.m == FermiDirac<2>::maxTriangles) {
+    quadratic ? applySteps<FermiDirac<2>, QuadraticEnergy>(
+                    net, linkIndices, energies, from, toStep)
+              : applySteps<FermiDirac<2>, LinearEnergy>(
+                    net, linkIndices, energies, from, toStep);
+  } else if (net.m == BoseEinstein::maxTriangles) {
+    quadratic ? applySteps<BoseEinstein, QuadraticEnergy>(
+                    net, linkIndices, energies, from, toStep)
+              : applySteps<BoseEinstein, LinearEnergy>(
+                    net, linkIndices, energies, from, toStep);
+  } else {
+    for (int s = from; s < toStep; ++s) {
+      int node = net.addNode(energies[s]);
+      net.attachTriangle(linkIndices[s], node, RuntimeStatistics{net.m},
+                         RuntimeEnergy{&net});
+    }
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FileSink;
+class Network;
+
+// What an event log stores besides the steps: enough to construct the
+// network it replays into
+struct EventLogHeader {
+  double beta = 0.0;
+  int m = 2;
+  bool quadraticEnergy = false; // ε = J(J+1) instead of ω_i + ω_j
+  int seed = 42;                // Network seed, also seeds replayed metrics
+  int seedEnergies[3] = {0, 0, 0}; // ω of the seed triangle's nodes
+};
+
+// Appends growth steps to a compact binary log (GrowthEngine::setEventLog).
+// A step is fully described by the link the new triangle attaches to and
+// the energy ω of the new node, whose id is implicit (3 + step). Both are
+// LEB128 varints: the link as its distance back from the newest link, ω
+// zigzag-encoded, so a step takes 2-5 bytes instead of a snapshot's ~60.
+// Steps are buffered; flush() hands every complete step to the file. Like
+// CsvWriter, full buffers go to AsyncWriter while it runs.
+class EventLogWriter {
+public:
+  // New log for a network holding only its seed triangle (t = 1)
+  EventLogWriter(const std::string &filename, const Network &net,
+                 bool quadraticEnergy, int seed);
+  // Existing log of a run resumed at `steps` steps: later steps (written
+  // after the checkpoint) are dropped and new ones are appended
+  EventLogWriter(const std::string &filename, std::uint64_t steps);
+  ~EventLogWriter(); // closes; errors are only reported by close()
+
+  EventLogWriter(const EventLogWriter &) = delete;
+  EventLogWriter &operator=(const EventLogWriter &) = delete;
+
+  void append(int link, int energy); // one growth step
+  void flush();
+  // Throws std::runtime_error if any write failed (with AsyncWriter
+  // running: AsyncWriter::stop() reports failures of queued writes)
+  void close();
+  std::uint64_t steps() const { return stepCount; }
+
+private:
+  std::string path;
+  std::shared_ptr<FileSink> sink;
+  std::vector<char> buffer;
+  std::uint64_t stepCount = 0;
+  std::int64_t links = 3; // links before the next step
+
+  void writeBuffer(bool close = false);
+};
+
+// A whole event log, decoded (8 bytes per step in memory). A torn last step
+// of a crashed run is dropped.
+class EventLog {
+public:
+  explicit EventLog(const std::string &filename); // throws if invalid
+
+  const EventLogHeader &header() const { return info; }
+  int steps() const { return static_cast<int>(energies.size()); }
+  int link(int step) const { return linkIndices[step]; }
+  int energy(int step) const { return energies[step]; }
+
+  // Energy function the run used, for constructing the replay network as
+  // Network(header().seed, header().m, header().beta, energyFunction())
+  std::function<double(int, int)> energyFunction() const;
+
+  // Seed triangle of an empty network
+  void start(Network &net) const;
+  // Applies steps numTriangles() - 1 ... toStep - 1 to a network replayed
+  // from this log, without sampling: it then equals the grown network
+  // after toStep steps
+  void replay(Network &net, int toStep) const;
+
+private:
+  EventLogHeader info;
+  std::vector<int> linkIndices;
+  std::vector<int> energies;
+};
@@ -0,0 +1,725 @@
+#include "experiment.hpp"
+#include "csv_writer.hpp"
+#include "event_log.hpp"
+#include "growth_engine.hpp"
+#include "metrics.hpp"
+#include "metrics_tracker.hpp"
+#include "network.hpp"
+#include "profiler.hpp"
+#include "simplicial_network.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::mutex logMutex; // jobs report from worker threads
+
+void logLine(std::ostream &stream, const std::string &line) {
+  std::lock_guard<std::mutex> lock(logMutex);
+  stream << line << std::endl;
+}
+} // namespace
+
+std::string formatBeta(double beta) {
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2) << beta;
+  std::string betaFormatted = oss.str();
+  std::replace(betaFormatted.begin(), betaFormatted.end(), '.', '_');
+  return betaFormatted;
+}
+
+SimulationJob makeSingleRunJob(bool isBose, bool useQuadraticEnergy,
+                               const std::string &outputPrefix, double beta,
+                               int targetTriangles,
+                               const std::string &outputDir) {
+  fs::path dir = outputDir;
+  std::string baseName = outputPrefix + "_beta" + formatBeta(beta) + "_N" +
+                         std::to_string(targetTriangles) + "_seed0";
+
+  SimulationJob job;
+  job.isBose = isBose;
+  job.useQuadraticEnergy = useQuadraticEnergy;
+  job.beta = beta;
+  job.targetTriangles = targetTriangles;
+  job.seed = 42;
+  job.series = outputPrefix;
+  job.metricsFile = (dir / (baseName + ".csv")).string();
+  job.edgesFile = (dir / (baseName + "_edges.csv")).string();
+  job.curvatureFile = (dir / (baseName + "_curvature_nodes.csv")).string();
+  job.degreeHistogramFile = (dir / (baseName + "_degree_hist.csv")).string();
+  job.curvatureHistogramFile =
+      (dir / (baseName + "_curvature_hist.csv")).string();
+  job.hopsFile = (dir / (baseName + "_hops.csv")).string();
+  job.spectralDensityFile =
+      (dir / (baseName + "_spectral_density.csv")).string();
+  job.heatKernelFile = (dir / (baseName + "_heat_kernel.csv")).string();
+  job.lowEigenvaluesFile =
+      (dir / (baseName + "_low_eigenvalues.csv")).string();
+  job.percolationFile = (dir / (baseName + "_percolation.csv")).string();
+  return job;
+}
+
+std::vector<SimulationJob>
+makeBetaSweepJobs(bool isBose, const std::vector<double> &betas,
+                  const std::vector<int> &triangleTargets,
+                  const std::string &outputPrefix, int seedOffset,
+                  const std::string &outputDir) {
+  fs::path dir = outputDir;
+  std::vector<SimulationJob> jobs;
+
+  for (double beta : betas) {
+    for (int N : triangleTargets) {
+      std::string stem = outputPrefix + "_beta" + formatBeta(beta) + "_N" +
+                         std::to_string(N);
+
+      SimulationJob job;
+      job.isBose = isBose;
+      job.beta = beta;
+      job.targetTriangles = N;
+      job.seed = 42 + seedOffset;
+      job.series = outputPrefix;
+      job.metricsFile =
+          (dir / (stem + "_seed" + std::to_string(seedOffset) + ".csv"))
+              .string();
+      job.edgesFile = (dir / (stem + "_edges.csv")).string();
+      job.curvatureFile = (dir / (stem + "_curvature_nodes.csv")).string();
+      job.degreeHistogramFile = (dir / (stem + "_degree_hist.csv")).string();
+      job.curvatureHistogramFile =
+          (dir / (stem + "_curvature_hist.csv")).string();
+      job.hopsFile = (dir / (stem + "_hops.csv")).string();
+      job.spectralDensityFile =
+          (dir / (stem + "_spectral_density.csv")).string();
+      job.heatKernelFile = (dir / (stem + "_heat_kernel.csv")).string();
+      job.lowEigenvaluesFile =
+          (dir / (stem + "_low_eigenvalues.csv")).string();
+      job.percolationFile = (dir / (stem + "_percolation.csv")).string();
+      jobs.push_back(job);
+    }
+  }
+
+  return jobs;
+}
+
+void dropOverwrittenOutputs(std::vector<SimulationJob> &jobs) {
+  std::set<std::string> claimed;
+  auto claim = [&claimed](std::string &path) {
+    if (!path.empty() && !claimed.insert(path).second)
+      path.clear();
+  };
+
+  for (auto it = jobs.rbegin(); it != jobs.rend(); ++it) {
+    claim(it->metricsFile);
+    claim(it->edgesFile);
+    claim(it->curvatureFile);
+    claim(it->degreeHistogramFile);
+    claim(it->curvatureHistogramFile);
+    claim(it->hopsFile);
+    claim(it->spectralDensityFile);
+    claim(it->heatKernelFile);
+    claim(it->lowEigenvaluesFile);
+    claim(it->percolationFile);
+  }
+
+  jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                            [](const SimulationJob &job) {
+                              return job.metricsFile.empty() &&
+                                     job.edgesFile.empty() &&
+                                     job.curvatureFile.empty() &&
+                                     job.degreeHistogramFile.empty() &&
+                                     job.curvatureHistogramFile.empty() &&
+                                     job.hopsFile.empty() &&
+                                     job.spectralDensityFile.empty() &&
+                                     job.heatKernelFile.empty() &&
+                                     job.lowEigenvaluesFile.empty() &&
+                                     job.percolationFile.empty();
+                            }),
+             jobs.end());
+}
+
+namespace {
+std::string firstOutputWithExtension(const SimulationJob &job,
+                                     const char *extension) {
+  for (const std::string *path :
+       {&job.metricsFile, &job.edgesFile, &job.curvatureFile,
+        &job.degreeHistogramFile, &job.curvatureHistogramFile,
+        &job.hopsFile, &job.spectralDensityFile, &job.heatKernelFile,
+        &job.lowEigenvaluesFile, &job.percolationFile}) {
+    if (!path->empty())
+      return fs::path(*path).replace_extension(extension).string();
+  }
+  return "";
+}
+} // namespace
+
+std::string defaultCheckpointFile(const SimulationJob &job) {
+  return firstOutputWithExtension(job, ".qsnap");
+}
+
+std::string defaultEventLogFile(const SimulationJob &job) {
+  return firstOutputWithExtension(job, ".qlog");
+}
+
+std::string describeJob(const SimulationJob &job) {
+  std::ostringstream oss;
+  oss << (job.isBose ? "bose" : "fermi") << " beta=" << job.beta
+      << " N=" << job.targetTriangles << " seed=" << job.seed;
+  return oss.str();
+}
+
+const char *const metricsHeader =
+    "step,max_distance,k_max,entropy,avg_clustering,modularity,"
+    "avg_path_length,diameter,spectral_dimension,percolation_random,"
+    "percolation_degree";
+
+void writeMetricRow(CsvWriter &out, const MetricRow &row) {
+  out << row.step << ',' << row.maxDistance << ',' << row.kMax << ','
+      << row.entropy << ',';
+  if (!std::isnan(row.avgClustering))
+    out << row.avgClustering;
+  for (double x : {row.modularity, row.avgPathLength, row.diameter,
+                   row.spectralDimension, row.percolationRandom,
+                   row.percolationDegree}) {
+    out << ',';
+    if (!std::isnan(x))
+      out << x;
+  }
+  out << '\n';
+}
+
+namespace {
+void exportDegreeHistogram(const Network &net, const std::string &filename) {
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(filename);
+  out << "k,count,avg_clustering\n";
+  for (const DegreeBin &bin : Metrics::degreeHistogram(net))
+    out << bin.k << ',' << bin.count << ',' << bin.avgClustering << '\n';
+  out.close();
+}
+
+void exportCurvatureHistogram(const Network &net,
+                              const std::string &filename) {
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(filename);
+  out << "curvature,count\n";
+  for (const CurvatureBin &bin : Metrics::curvatureHistogram(net))
+    out << bin.curvature << ',' << bin.count << '\n';
+  out.close();
+}
+
+// Nodes at each distance from the seed triangle, and the (root, target)
+// pairs at that distance from the path-length roots
+void exportHops(const Network &net, const PathLengthStats &paths,
+                const std::string &filename) {
+  ProfileScope scope(ProfilePhase::Export);
+  std::vector<long long> fromSeed = Metrics::hopDistribution(net);
+  std::size_t rows = std::max(fromSeed.size(), paths.pairs.size());
+  fromSeed.resize(rows, 0);
+
+  CsvWriter out(filename);
+  out << "distance,from_seed,pairs\n";
+  for (std::size_t d = 0; d < rows; ++d)
+    out << static_cast<long long>(d) << ',' << fromSeed[d] << ','
+        << (d < paths.pairs.size() ? paths.pairs[d] : 0) << '\n';
+  out.close();
+}
+
+// KPM density and heat kernel, Lanczos low eigenvalues; returns the
+// spectral dimension fitted over the last decade of resolved t
+double analyzeSpectrum(const Network &net, const SimulationJob &job) {
+  unsigned seed = static_cast<unsigned>(job.seed);
+  SparseLaplacian laplacian = Metrics::laplacian(net);
+  std::vector<SpectralBin> density;
+  std::vector<HeatKernelPoint> heat;
+  std::vector<RitzValue> low;
+  double dimension;
+  {
+    ProfileScope scope(ProfilePhase::Metrics);
+    KernelPolynomial kpm(laplacian, job.spectralMoments, job.spectralVectors,
+                         job.spectralThreads, seed);
+    density = kpm.density(200);
+    heat = kpm.heatKernel(0.1, 100);
+    dimension = spectralDimension(heat, laplacian.size(), kpm.maxTime() / 10,
+                                  kpm.maxTime());
+    if (!job.lowEigenvaluesFile.empty())
+      low = lowEigenvalues(laplacian, 10, 300, job.spectralThreads, seed);
+  }
+
+  ProfileScope scope(ProfilePhase::Export);
+  if (!job.spectralDensityFile.empty()) {
+    CsvWriter out(job.spectralDensityFile);
+    out << "lambda,density\n";
+    for (const SpectralBin &bin : density)
+      out << bin.lambda << ',' << bin.density << '\n';
+    out.close();
+  }
+  if (!job.heatKernelFile.empty()) {
+    CsvWriter out(job.heatKernelFile);
+    out << "t,return_probability,uncertainty,spectral_dimension\n";
+    for (const HeatKernelPoint &point : heat)
+      out << point.t << ',' << point.returnProbability << ','
+          << point.uncertainty << ',' << point.localDimension << '\n';
+    out.close();
+  }
+  if (!job.lowEigenvaluesFile.empty()) {
+    CsvWriter out(job.lowEigenvaluesFile);
+    out << "index,eigenvalue,residual\n";
+    for (std::size_t k = 0; k < low.size(); ++k)
+      out << static_cast<long long>(k + 1) << ',' << low[k].value << ','
+          << low[k].residual << '\n';
+    out.close();
+  }
+  return dimension;
+}
+
+// Giant component curves under random and degree-targeted removal, written
+// at up to 1000 points; returns the two thresholds
+std::pair<double, double> analyzePercolation(const Network &net,
+                                             const SimulationJob &job) {
+  unsigned seed = static_cast<unsigned>(job.seed);
+  PercolationCurve random, targeted;
+  {
+    ProfileScope scope(ProfilePhase::Metrics);
+    DistanceGraph graph = Metrics::distanceGraph(net);
+    random = Percolation::compute(graph, RemovalOrder::Random,
+                                  job.percolationOrders,
+                                  job.percolationThreads, seed);
+    targeted = Percolation::compute(graph, RemovalOrder::Degree,
+                                    job.percolationOrders,
+                                    job.percolationThreads, seed);
+  }
+  std::pair<double, double> thresholds(random.threshold, targeted.threshold);
+  if (job.percolationFile.empty())
+    return thresholds;
+
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(job.percolationFile);
+  out << "removed_fraction,giant_random,giant_degree\n";
+  long long n = net.numNodes();
+  long long points = std::min(n, 1000LL);
+  for (long long p = 0; p <= points; ++p) {
+    long long k = n * p / points; // nodes removed
+    out << static_cast<double>(k) / n << ',' << random.giant[k] << ','
+        << targeted.giant[k] << '\n';
+  }
+  out.close();
+  return thresholds;
+}
+
+// The value as printed in the metrics CSV (6 significant digits), so the
+// summary is the same whether rows come from memory or from a resumed file
+double asWritten(double x) {
+  if (std::isnan(x))
+    return x;
+  char text[32];
+  std::snprintf(text, sizeof(text), "%g", x);
+  return std::strtod(text, nullptr);
+}
+
+MetricRow parseMetricRow(const std::string &line) {
+  std::vector<std::string> fields;
+  std::stringstream in(line);
+  std::string field;
+  while (std::getline(in, field, ','))
+    fields.push_back(field);
+  fields.resize(11); // older files lack the last columns
+
+  auto number = [](const std::string &text) {
+    return text.empty() ? std::numeric_limits<double>::quiet_NaN()
+                        : std::stod(text);
+  };
+  MetricRow row;
+  row.step = std::stoll(fields[0]);
+  row.maxDistance = std::stoi(fields[1]);
+  row.kMax = std::stoi(fields[2]);
+  row.entropy = number(fields[3]);
+  row.avgClustering = number(fields[4]);
+  row.modularity = number(fields[5]);
+  row.avgPathLength = number(fields[6]);
+  row.diameter = number(fields[7]);
+  row.spectralDimension = number(fields[8]);
+  row.percolationRandom = number(fields[9]);
+  row.percolationDegree = number(fields[10]);
+  return row;
+}
+
+// Keeps the header and the rows logged before `step`, so a resumed run
+// appends exactly the rows an uninterrupted run would have written.
+// Returns the rows kept.
+std::vector<MetricRow> truncateMetricsFile(const std::string &filename,
+                                           std::uint64_t step) {
+  std::ifstream in(filename);
+  std::string header;
+  std::getline(in, header);
+
+  std::vector<std::string> rows;
+  std::string line;
+  while (std::getline(in, line) && !in.eof()) { // skip a torn last line
+    std::uint64_t rowStep = std::stoull(line.substr(0, line.find(',')));
+    if (rowStep >= step)
+      break;
+    rows.push_back(line);
+  }
+  in.close();
+
+  std::ofstream out(filename, std::ios::trunc);
+  out << (header.empty() ? metricsHeader : header) << "\n";
+  std::vector<MetricRow> kept;
+  for (const std::string &row : rows) {
+    out << row << "\n";
+    kept.push_back(parseMetricRow(row));
+  }
+  return kept;
+}
+
+// Reports the end of a job to its telemetry: failed unless marked done,
+// so jobs that throw are not left running
+struct ProgressFinish {
+  JobProgress *progress;
+  bool failed = true;
+  ~ProgressFinish() {
+    if (progress)
+      progress->finish(failed);
+  }
+};
+
+// Steps between telemetry updates: a few ms of growth
+constexpr int kProgressSteps = 1 << 14;
+
+// runJob for job.dimension = D > 2: the same growth loop, metric rows and
+// exports on a SimplicialNetwork<D>. Only the O(1) metrics exist there, so
+// the other columns of the final row stay empty.
+template <int D>
+MetricRow runSimplicialJob(const SimulationJob &job,
+                           EnsembleAggregator *ensemble,
+                           JobProgress *progress) {
+  ProgressFinish finish{progress};
+  std::string phase = job.isBose ? "Bose-Einstein" : "Fermi-Dirac";
+  int m = job.isBose ? std::numeric_limits<int>::max() : 2;
+
+  SimplicialNetwork<D> net(job.seed, m, job.beta);
+  net.initialize();
+  net.reserve(job.targetTriangles);
+  SimplicialGrowthEngine<D> engine(net, job.lambda);
+  if (progress)
+    progress->begin(net.numSimplices());
+
+  std::unique_ptr<CsvWriter> out;
+  bool collect = ensemble && job.summarize;
+  std::vector<MetricRow> rows; // for the ensemble
+  auto logRow = [&](MetricRow row) {
+    if (out)
+      writeMetricRow(*out, row);
+    if (collect) {
+      row.entropy = asWritten(row.entropy);
+      rows.push_back(row);
+    }
+  };
+  auto trackedRow = [&net](long long step) {
+    MetricRow row;
+    row.step = step;
+    row.maxDistance = net.maxDistanceFromInitialSimplex();
+    row.kMax = net.maxDegree();
+    row.entropy = net.entropyRate();
+    return row;
+  };
+
+  if (!job.metricsFile.empty()) {
+    fs::create_directories(fs::path(job.metricsFile).parent_path());
+    logLine(std::cout, "📁 Writing to: " + job.metricsFile);
+    out = std::make_unique<CsvWriter>(job.metricsFile);
+    *out << metricsHeader << '\n';
+  }
+
+  int step = 0;
+  while (net.numSimplices() < job.targetTriangles) {
+    // As in runJob: grow up to the next metric row or the target
+    int chunk = job.targetTriangles - net.numSimplices();
+    if (out || collect) {
+      int toRow = (job.metricInterval - step % job.metricInterval) %
+                  job.metricInterval;
+      chunk = std::min(chunk, toRow + 1);
+    }
+    if (progress)
+      chunk = std::min(chunk, kProgressSteps);
+
+    int before = net.numSimplices();
+    bool failed = false;
+    try {
+      engine.growSteps(chunk);
+    } catch (const std::runtime_error &e) {
+      logLine(std::cerr, std::string("❌ ERROR during growth: ") + e.what());
+      failed = true;
+    }
+    step += net.numSimplices() - before;
+    if (progress)
+      progress->update(net.numSimplices(), net.partitionFunction(),
+                       net.entropyRate(), net.memoryBytes());
+    if (failed)
+      break;
+
+    // The grown network is logged once, as the final row
+    int last = step - 1;
+    if ((out || collect) && last % job.metricInterval == 0 &&
+        net.numSimplices() < job.targetTriangles) {
+      ProfileScope scope(ProfilePhase::Metrics);
+      logRow(trackedRow(last));
+    }
+  }
+
+  // Final row: the grown network, labelled like the periodic rows
+  MetricRow row = trackedRow(std::max(step - 1, 0));
+  if (out || collect) {
+    logRow(row);
+    if (out)
+      out->close();
+  }
+  if (collect)
+    ensemble->addRun(job.series, job.beta, job.targetTriangles, job.seed,
+                     std::move(rows));
+
+  if (!job.curvatureFile.empty())
+    net.exportNodeCurvatures(job.curvatureFile);
+  if (!job.edgesFile.empty())
+    net.exportEdgeList(job.edgesFile);
+
+  std::ostringstream summary;
+  summary << "[" << phase << " d=" << D << "] β=" << job.beta
+          << ", N=" << job.targetTriangles << ", seed=" << job.seed
+          << ", steps=" << step << ", Nodes=" << net.numNodes();
+  logLine(std::cout, summary.str());
+  finish.failed = net.numSimplices() < job.targetTriangles;
+  return row;
+}
+} // namespace
+
+MetricRow runJob(const SimulationJob &job, EnsembleAggregator *ensemble,
+                 JobProgress *progress) {
+  if (job.dimension == 3)
+    return runSimplicialJob<3>(job, ensemble, progress);
+  if (job.dimension == 4)
+    return runSimplicialJob<4>(job, ensemble, progress);
+  if (job.dimension != 2)
+    throw std::invalid_argument("dimension must be 2, 3 or 4");
+
+  ProgressFinish finish{progress};
+  std::function<double(int, int)> selectedEnergy = LinearEnergy();
+  if (job.useQuadraticEnergy)
+    selectedEnergy = QuadraticEnergy();
+  std::string phase = job.isBose ? "Bose-Einstein" : "Fermi-Dirac";
+  int m = job.isBose ? std::numeric_limits<int>::max() : 2;
+
+  Network net(job.seed, m, job.beta, selectedEnergy);
+  if (job.leanStorage)
+    net.setStorage(NetworkStorage::Lean);
+  GrowthEngine engine(net, job.lambda);
+  // Same network, compiled for this m and energy (no std::function calls)
+  GrowthKernel grow = selectGrowthKernel(m, job.useQuadraticEnergy);
+
+  int step = 0;
+  bool resumed = job.resume && !job.checkpointFile.empty() &&
+                 fs::exists(job.checkpointFile);
+  if (resumed) {
+    SnapshotInfo info = net.loadSnapshot(job.checkpointFile);
+    engine.loadState(info.engineState);
+    step = static_cast<int>(info.step);
+    logLine(std::cout, "⏩ Resuming " + job.checkpointFile + " at step " +
+                           std::to_string(step));
+  } else {
+    net.initialize();
+  }
+
+  if (job.useEnergyClasses)
+    engine.setSamplingMode(SamplingMode::EnergyClasses);
+
+  std::unique_ptr<EventLogWriter> eventLog;
+  if (!job.eventLogFile.empty()) {
+    if (resumed && !fs::exists(job.eventLogFile))
+      logLine(std::cerr, "⚠️ No event log to continue for " +
+                             job.checkpointFile + ", not logging this run");
+    else if (resumed)
+      eventLog = std::make_unique<EventLogWriter>(job.eventLogFile, step);
+    else
+      eventLog = std::make_unique<EventLogWriter>(
+          job.eventLogFile, net, job.useQuadraticEnergy, job.seed);
+    engine.setEventLog(eventLog.get());
+  }
+  MetricsTracker tracker(net); // O(1) metrics at every step
+  net.reserve(job.targetTriangles); // no reallocation while growing
+  if (progress)
+    progress->begin(net.numTriangles());
+
+  std::unique_ptr<CsvWriter> out;
+  bool collect = ensemble && job.summarize;
+  std::vector<MetricRow> rows; // for the ensemble
+  auto logRow = [&](MetricRow row) {
+    if (out)
+      writeMetricRow(*out, row);
+    if (collect) {
+      for (double *x : {&row.entropy, &row.avgClustering, &row.modularity,
+                        &row.avgPathLength, &row.spectralDimension,
+                        &row.percolationRandom, &row.percolationDegree})
+        *x = asWritten(*x);
+      rows.push_back(row);
+    }
+  };
+
+  if (!job.metricsFile.empty()) {
+    fs::create_directories(fs::path(job.metricsFile).parent_path());
+    logLine(std::cout, "📁 Writing to: " + job.metricsFile);
+    if (resumed && fs::exists(job.metricsFile)) {
+      rows = truncateMetricsFile(job.metricsFile, step);
+      out = std::make_unique<CsvWriter>(job.metricsFile, true);
+    } else {
+      out = std::make_unique<CsvWriter>(job.metricsFile);
+      *out << metricsHeader << '\n';
+    }
+  }
+
+  while (net.numTriangles() < job.targetTriangles) {
+    // Grow in one call up to the next metric row, checkpoint or the target.
+    // Step `step` is logged if step % metricInterval == 0 and a checkpoint
+    // follows when (step + 1) % checkpointInterval == 0.
+    int chunk = job.targetTriangles - net.numTriangles();
+    if (out || collect) {
+      int toRow = (job.metricInterval - step % job.metricInterval) %
+                  job.metricInterval;
+      chunk = std::min(chunk, toRow + 1);
+    }
+    if (job.checkpointInterval > 0)
+      chunk = std::min(chunk, job.checkpointInterval -
+                                  step % job.checkpointInterval);
+    if (progress)
+      chunk = std::min(chunk, kProgressSteps);
+
+    int before = net.numTriangles();
+    bool failed = false;
+    try {
+      grow(engine, chunk);
+    } catch (const std::runtime_error &e) {
+      logLine(std::cerr, std::string("❌ ERROR during growth: ") + e.what());
+      failed = true; // Don't exit(1); just stop this simulation
+    }
+    step += net.numTriangles() - before;
+    if (progress)
+      progress->update(net.numTriangles(), tracker.partitionFunction(),
+                       tracker.entropyRate(), net.memoryBytes());
+    if (failed)
+      break;
+
+    // Row s holds the network after s + 1 steps; the grown network is
+    // logged once, as the final row (with the costly metrics)
+    int last = step - 1; // the step that just completed
+    if ((out || collect) && last % job.metricInterval == 0 &&
+        net.numTriangles() < job.targetTriangles) {
+      ProfileScope scope(ProfilePhase::Metrics);
+      MetricRow row;
+      row.step = last;
+      row.maxDistance = tracker.maxDistanceFromInitialTriangle();
+      row.kMax = tracker.maxDegree();
+      row.entropy = tracker.entropyRate();
+      logRow(row);
+    }
+
+    if (job.checkpointInterval > 0 && step % job.checkpointInterval == 0 &&
+        !job.checkpointFile.empty()) {
+      if (out)
+        out->flush(); // rows before the checkpoint must survive a crash
+      if (eventLog)
+        eventLog->flush(); // and so must the steps
+      SnapshotInfo info;
+      info.step = step;
+      info.engineState = engine.saveState();
+      net.saveSnapshot(job.checkpointFile, info);
+    }
+  }
+
+  // Shortest paths from the sampled roots, for the final row and hops file
+  PathLengthStats paths;
+  if (out || collect || !job.hopsFile.empty())
+    paths = Metrics::pathLengths(net, job.pathSamples, job.pathThreads,
+                                 static_cast<unsigned>(job.seed));
+
+  // Laplacian spectrum: d_s for the final row, and the spectral files
+  double spectralDim = std::numeric_limits<double>::quiet_NaN();
+  if (job.spectral)
+    spectralDim = analyzeSpectrum(net, job);
+
+  // Percolation thresholds for the final row, and the curves file
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  std::pair<double, double> percolation(nan, nan);
+  if (job.percolation)
+    percolation = analyzePercolation(net, job);
+
+  MetricRow row; // final row: the grown network, labelled as above
+  row.step = std::max(step - 1, 0);
+  row.maxDistance = tracker.maxDistanceFromInitialTriangle();
+  row.kMax = tracker.maxDegree();
+  row.entropy = tracker.entropyRate();
+  if (out || collect) {
+    // ... plus the metrics too costly per step
+    ProfileScope scope(ProfilePhase::Metrics);
+    row.avgClustering = Metrics::averageClustering(net);
+    if (job.louvainRestarts > 0) // else empty, like other skipped metrics
+      row.modularity = Metrics::louvain(net, job.louvainRestarts,
+                                        job.louvainThreads,
+                                        static_cast<unsigned>(job.seed))
+                           .modularity;
+    row.avgPathLength = paths.averagePathLength;
+    row.diameter = paths.diameter;
+    row.spectralDimension = spectralDim;
+    row.percolationRandom = percolation.first;
+    row.percolationDegree = percolation.second;
+    logRow(row);
+    if (out)
+      out->close();
+  }
+  if (collect)
+    ensemble->addRun(job.series, job.beta, job.targetTriangles, job.seed,
+                     std::move(rows));
+
+  if (!job.degreeHistogramFile.empty())
+    exportDegreeHistogram(net, job.degreeHistogramFile);
+  if (!job.curvatureHistogramFile.empty())
+    exportCurvatureHistogram(net, job.curvatureHistogramFile);
+  if (!job.hopsFile.empty())
+    exportHops(net, paths, job.hopsFile);
+  if (!job.curvatureFile.empty())
+    net.exportNodeCurvatures(job.curvatureFile);
+  if (!job.edgesFile.empty())
+    net.exportEdgeList(job.edgesFile);
+
+  if (eventLog) {
+    engine.setEventLog(nullptr);
+    eventLog->close();
+  }
+  if (!job.checkpointFile.empty())
+    fs::remove(job.checkpointFile); // finished runs restart from scratch
+
+  std::ostringstream summary;
+  summary << "[" << phase << "] β=" << job.beta
+          << ", N=" << job.targetTriangles << ", seed=" << job.seed
+          << ", steps=" << step << ", Nodes=" << net.numNodes();
+  logLine(std::cout, summary.str());
+  finish.failed = net.numTriangles() < job.targetTriangles; // growth stopped
+  return row;
+}
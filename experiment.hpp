@@ -0,0 +1,118 @@
+#pragma once
+#include "ensemble.hpp"
+
+#include <string>
+#include <vector>
+
+class CsvWriter;
+class JobProgress;
+
+// One independent growth run and the files it writes. Every job owns its
+// Network (and thus its RNG), so jobs can run on any thread in any order.
+struct SimulationJob {
+  bool isBose = false;
+  bool useQuadraticEnergy = false;
+  bool useEnergyClasses = false; // SamplingMode::EnergyClasses
+  bool leanStorage = false;      // NetworkStorage::Lean
+  // Simplices grown: 2 = triangles (Network), 3 or 4 = tetrahedra and
+  // 4-simplices (SimplicialNetwork; targetTriangles counts them)
+  int dimension = 2;
+  double beta = 0.0;
+  int targetTriangles = 0;
+  int seed = 42;            // seeds Network::rng
+  int lambda = 7;           // mean of the Poisson node-energy sampler
+  int metricInterval = 666; // steps between metric rows
+
+  std::string series;     // output prefix; groups runs in the summary
+  bool summarize = true;  // add this run's rows to the ensemble summary
+
+  // step,max_distance,k_max,entropy,avg_clustering,modularity,
+  // avg_path_length,diameter,spectral_dimension,percolation_random,
+  // percolation_degree; the last seven are filled only in the final row
+  // (state after the last step)
+  std::string metricsFile;
+  std::string edgesFile;              // Source,Target
+  std::string curvatureFile;          // Node,Curvature
+  std::string degreeHistogramFile;    // k,count,avg_clustering
+  std::string curvatureHistogramFile; // curvature,count
+  std::string hopsFile;               // distance,from_seed,pairs
+  std::string spectralDensityFile;    // lambda,density
+  std::string heatKernelFile;         // t,return_probability,...,d_s(t)
+  std::string lowEigenvaluesFile;     // index,eigenvalue,residual
+  std::string percolationFile; // removed_fraction,giant_random,giant_degree
+
+  // Louvain restarts for the final modularity (0 = skip: the cell stays
+  // empty) and the threads they run on; the partition does not depend on
+  // the thread count
+  int louvainRestarts = 4;
+  int louvainThreads = 1;
+
+  // BFS roots for the average path length and diameter (0 = every node,
+  // exact; otherwise the diameter is a lower bound) and their threads
+  int pathSamples = 64;
+  int pathThreads = 1;
+
+  // Normalized Laplacian spectrum of the final network (spectral.hpp):
+  // KPM moments from random vectors, mat-vecs on spectralThreads threads
+  bool spectral = false;
+  int spectralMoments = 400;
+  int spectralVectors = 8;
+  int spectralThreads = 1;
+
+  // Giant component under random and degree-targeted node removal of the
+  // final network (percolation.hpp), averaged over percolationOrders
+  // removal orders each, on percolationThreads threads
+  bool percolation = false;
+  int percolationOrders = 16;
+  int percolationThreads = 1;
+
+  // Periodic binary snapshots (Network::saveSnapshot); 0 = off. With resume
+  // set, an existing checkpoint is loaded and the run continues from it.
+  std::string checkpointFile;
+  int checkpointInterval = 0;
+  bool resume = false;
+
+  // Growth event log (event_log.hpp), empty = off; continued on resume
+  std::string eventLogFile;
+};
+
+std::string formatBeta(double beta); // 0.05 -> "0_05"
+
+// Header and rows of the metrics CSV; NaN metrics are left empty
+extern const char *const metricsHeader;
+void writeMetricRow(CsvWriter &out, const MetricRow &row);
+
+// Single realization named <outputDir>/<prefix>_beta<β>_N<N>_seed0[...]
+SimulationJob makeSingleRunJob(bool isBose, bool useQuadraticEnergy,
+                               const std::string &outputPrefix, double beta,
+                               int targetTriangles = 100000,
+                               const std::string &outputDir = "raw_csv");
+
+// One job per (β, N) with seed 42 + seedOffset
+std::vector<SimulationJob>
+makeBetaSweepJobs(bool isBose, const std::vector<double> &betas,
+                  const std::vector<int> &triangleTargets,
+                  const std::string &outputPrefix, int seedOffset = 0,
+                  const std::string &outputDir = "raw_csv");
+
+// Files written by several jobs used to be overwritten in program order. To
+// keep that result without two threads writing one file, only the last job
+// keeps each path (others get an empty path, which runJob skips), and jobs
+// left with no output at all are removed.
+void dropOverwrittenOutputs(std::vector<SimulationJob> &jobs);
+
+// <first output file>.qsnap; unique because output paths are unique per job
+std::string defaultCheckpointFile(const SimulationJob &job);
+std::string defaultEventLogFile(const SimulationJob &job); // same, .qlog
+
+// "bose beta=0.5 N=1000 seed=42", for job lists and failure reports
+std::string describeJob(const SimulationJob &job);
+
+// Runs the job; with an ensemble, its metric rows (as written to the CSV)
+// are also handed to it if job.summarize is set. Returns the final row: the
+// per-step metrics always, the others only when rows are written or
+// collected (NaN otherwise). With `progress` the job reports its growth
+// to the sweep's Telemetry, including whether it finished or failed.
+MetricRow runJob(const SimulationJob &job,
+                 EnsembleAggregator *ensemble = nullptr,
+                 JobProgress *progress = nullptr);
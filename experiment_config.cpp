@@ -0,0 +1,544 @@
+#include "experiment_config.hpp"
+#include "async_writer.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string trim(const std::string &text) {
+  const char *space = " \t\r\n";
+  std::size_t first = text.find_first_not_of(space);
+  if (first == std::string::npos)
+    return "";
+  std::size_t last = text.find_last_not_of(space);
+  return text.substr(first, last - first + 1);
+}
+
+std::vector<std::string> splitList(const std::string &value) {
+  std::vector<std::string> items;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    item = trim(item);
+    if (!item.empty())
+      items.push_back(item);
+  }
+  return items;
+}
+
+int parseInt(const std::string &key, const std::string &value) {
+  try {
+    std::size_t used = 0;
+    int result = std::stoi(value, &used);
+    if (used == value.size())
+      return result;
+  } catch (const std::exception &) {
+  }
+  throw std::invalid_argument("--" + key + ": expected an integer, got '" +
+                              value + "'");
+}
+
+double parseDouble(const std::string &key, const std::string &value) {
+  try {
+    std::size_t used = 0;
+    double result = std::stod(value, &used);
+    if (used == value.size())
+      return result;
+  } catch (const std::exception &) {
+  }
+  throw std::invalid_argument("--" + key + ": expected a number, got '" +
+                              value + "'");
+}
+
+bool parseBool(const std::string &key, const std::string &value) {
+  if (value == "1" || value == "true" || value == "yes")
+    return true;
+  if (value == "0" || value == "false" || value == "no")
+    return false;
+  throw std::invalid_argument("--" + key + ": expected true/false, got '" +
+                              value + "'");
+}
+
+bool isFlag(const std::string &key) {
+  return key == "list-jobs" || key == "help" || key == "resume" ||
+         key == "summary-only" || key == "quantiles" || key == "spectral" ||
+         key == "event-log" || key == "compress-exports" ||
+         key == "sync-output" || key == "percolation";
+}
+} // namespace
+
+void applyOption(ExperimentConfig &config, const std::string &key,
+                 const std::string &value) {
+  if (key == "statistics") {
+    config.statistics = splitList(value);
+  } else if (key == "energy") {
+    config.energy = value;
+  } else if (key == "sampler") {
+    config.sampler = value;
+  } else if (key == "storage") {
+    config.storage = value;
+  } else if (key == "dimension") {
+    config.dimension = parseInt(key, value);
+  } else if (key == "betas") {
+    config.betas.clear();
+    for (const std::string &item : splitList(value))
+      config.betas.push_back(parseDouble(key, item));
+  } else if (key == "triangles") {
+    config.triangleTargets.clear();
+    for (const std::string &item : splitList(value))
+      config.triangleTargets.push_back(parseInt(key, item));
+  } else if (key == "seeds") {
+    config.seedOffsets.clear();
+    for (const std::string &item : splitList(value))
+      config.seedOffsets.push_back(parseInt(key, item));
+  } else if (key == "trials") {
+    int trials = parseInt(key, value);
+    config.seedOffsets.clear();
+    for (int trial = 0; trial < trials; ++trial)
+      config.seedOffsets.push_back(trial * 1000);
+  } else if (key == "lambda") {
+    config.lambda = parseInt(key, value);
+  } else if (key == "metric-interval") {
+    config.metricInterval = parseInt(key, value);
+  } else if (key == "output-dir") {
+    config.outputDir = value;
+  } else if (key == "tag") {
+    config.tag = value;
+  } else if (key == "checkpoint-interval") {
+    config.checkpointInterval = parseInt(key, value);
+  } else if (key == "resume") {
+    config.resume = parseBool(key, value);
+  } else if (key == "louvain-restarts") {
+    config.louvainRestarts = parseInt(key, value);
+  } else if (key == "louvain-threads") {
+    config.louvainThreads = parseInt(key, value);
+  } else if (key == "path-samples") {
+    config.pathSamples = parseInt(key, value);
+  } else if (key == "path-threads") {
+    config.pathThreads = parseInt(key, value);
+  } else if (key == "spectral") {
+    config.spectral = parseBool(key, value);
+  } else if (key == "spectral-moments") {
+    config.spectralMoments = parseInt(key, value);
+  } else if (key == "spectral-vectors") {
+    config.spectralVectors = parseInt(key, value);
+  } else if (key == "spectral-threads") {
+    config.spectralThreads = parseInt(key, value);
+  } else if (key == "percolation") {
+    config.percolation = parseBool(key, value);
+  } else if (key == "percolation-orders") {
+    config.percolationOrders = parseInt(key, value);
+  } else if (key == "percolation-threads") {
+    config.percolationThreads = parseInt(key, value);
+  } else if (key == "adaptive") {
+    config.adaptive = value;
+  } else if (key == "beta-tolerance") {
+    config.betaTolerance = parseDouble(key, value);
+  } else if (key == "adaptive-seeds") {
+    config.adaptiveSeeds = parseInt(key, value);
+  } else if (key == "max-seeds") {
+    config.maxSeeds = parseInt(key, value);
+  } else if (key == "refine-points") {
+    config.refinePoints = parseInt(key, value);
+  } else if (key == "summary") {
+    config.summaryFile = value;
+  } else if (key == "event-log") {
+    config.eventLog = parseBool(key, value);
+  } else if (key == "summary-only") {
+    config.summaryOnly = parseBool(key, value);
+  } else if (key == "quantiles") {
+    config.quantiles = parseBool(key, value);
+  } else if (key == "profile") {
+    config.profileFile = value;
+  } else if (key == "compress-exports") {
+    config.compressExports = parseBool(key, value);
+  } else if (key == "sync-output") {
+    config.syncOutput = parseBool(key, value);
+  } else if (key == "telemetry") {
+    config.telemetryFile = value;
+  } else if (key == "telemetry-interval") {
+    config.telemetryInterval = parseDouble(key, value);
+  } else if (key == "threads") {
+    config.threads = parseInt(key, value);
+  } else if (key == "job-index") {
+    config.jobIndex = parseInt(key, value);
+  } else if (key == "job-count") {
+    config.jobCount = parseInt(key, value);
+  } else if (key == "list-jobs") {
+    config.listJobs = parseBool(key, value);
+  } else if (key == "help") {
+    config.showHelp = parseBool(key, value);
+  } else {
+    throw std::invalid_argument("unknown option '" + key + "'");
+  }
+}
+
+void loadConfigFile(const std::string &path, ExperimentConfig &config) {
+  std::ifstream in(path);
+  if (!in)
+    throw std::invalid_argument("cannot open config file '" + path + "'");
+
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty())
+      continue;
+
+    std::size_t eq = line.find('=');
+    if (eq == std::string::npos)
+      throw std::invalid_argument(path + ":" + std::to_string(lineNumber) +
+                                  ": expected key = value");
+    applyOption(config, trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+  }
+}
+
+ExperimentConfig parseCommandLine(int argc, char **argv) {
+  ExperimentConfig config;
+  std::vector<std::pair<std::string, std::string>> options;
+
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    if (arg.rfind("--", 0) != 0)
+      throw std::invalid_argument("unexpected argument '" + arg + "'");
+
+    std::string key = arg.substr(2);
+    std::string value;
+    std::size_t eq = key.find('=');
+    if (eq != std::string::npos) {
+      value = key.substr(eq + 1);
+      key = key.substr(0, eq);
+    } else if (isFlag(key)) {
+      value = "true";
+    } else if (a + 1 < argc) {
+      value = argv[++a];
+    } else {
+      throw std::invalid_argument("--" + key + " needs a value");
+    }
+
+    if (key == "config")
+      loadConfigFile(value, config); // file first, so later flags override
+    else
+      options.emplace_back(key, value);
+  }
+
+  for (const auto &[key, value] : options)
+    applyOption(config, key, value);
+
+  validateConfig(config);
+  return config;
+}
+
+void validateConfig(const ExperimentConfig &config) {
+  if (config.statistics.empty())
+    throw std::invalid_argument("--statistics: nothing selected");
+  for (const std::string &name : config.statistics) {
+    if (name != "fermi" && name != "bose")
+      throw std::invalid_argument("--statistics: expected fermi and/or bose, "
+                                  "got '" + name + "'");
+  }
+  if (config.energy != "linear" && config.energy != "quadratic")
+    throw std::invalid_argument("--energy: expected linear or quadratic");
+  if (config.sampler != "tree" && config.sampler != "classes")
+    throw std::invalid_argument("--sampler: expected tree or classes");
+  if (config.storage != "full" && config.storage != "lean")
+    throw std::invalid_argument("--storage: expected full or lean");
+  if (config.dimension < 2 || config.dimension > 4)
+    throw std::invalid_argument("--dimension: expected 2, 3 or 4");
+  if (config.dimension != 2 &&
+      (config.energy != "linear" || config.sampler != "tree" ||
+       config.storage != "full" || config.checkpointInterval > 0 ||
+       config.resume || config.eventLog || config.spectral ||
+       config.percolation))
+    throw std::invalid_argument(
+        "--dimension 3 and 4 grow with the linear energy and the tree "
+        "sampler, without checkpoints, event logs, --spectral or "
+        "--percolation");
+  if (config.adaptive.empty() &&
+      config.betas.empty() != config.triangleTargets.empty())
+    throw std::invalid_argument(
+        "--betas and --triangles must be given together");
+  if (config.seedOffsets.empty())
+    throw std::invalid_argument("--seeds: at least one seed is required");
+  for (int N : config.triangleTargets) {
+    if (N < 1)
+      throw std::invalid_argument("--triangles: targets must be positive");
+  }
+  if (config.lambda < 0)
+    throw std::invalid_argument("--lambda must be >= 0");
+  if (config.metricInterval < 1)
+    throw std::invalid_argument("--metric-interval must be >= 1");
+  if (config.compressExports && !FileSink::compressionAvailable())
+    throw std::invalid_argument(
+        "--compress-exports needs zlib, which this build was made without");
+  if (!(config.telemetryInterval > 0.0))
+    throw std::invalid_argument("--telemetry-interval must be > 0");
+  if (config.checkpointInterval < 0)
+    throw std::invalid_argument("--checkpoint-interval must be >= 0");
+  if (config.louvainRestarts < 0)
+    throw std::invalid_argument("--louvain-restarts must be >= 0");
+  if (config.louvainThreads < 1)
+    throw std::invalid_argument("--louvain-threads must be >= 1");
+  if (config.pathSamples < 0)
+    throw std::invalid_argument("--path-samples must be >= 0");
+  if (config.pathThreads < 1)
+    throw std::invalid_argument("--path-threads must be >= 1");
+  if (config.spectralMoments < 2)
+    throw std::invalid_argument("--spectral-moments must be >= 2");
+  if (config.spectralVectors < 1)
+    throw std::invalid_argument("--spectral-vectors must be >= 1");
+  if (config.spectralThreads < 1)
+    throw std::invalid_argument("--spectral-threads must be >= 1");
+  if (config.percolationOrders < 1)
+    throw std::invalid_argument("--percolation-orders must be >= 1");
+  if (config.percolationThreads < 1)
+    throw std::invalid_argument("--percolation-threads must be >= 1");
+  if (config.summaryOnly && (config.checkpointInterval > 0 || config.resume))
+    throw std::invalid_argument(
+        "--summary-only cannot be combined with checkpoints: resumed runs "
+        "re-read their rows from the per-seed metrics files");
+  if (config.eventLog && config.summaryOnly)
+    throw std::invalid_argument(
+        "--event-log names each log after its per-seed metrics file: it "
+        "cannot be combined with --summary-only");
+  if (config.jobCount < 1 || config.jobIndex < 0 ||
+      config.jobIndex >= config.jobCount)
+    throw std::invalid_argument("need 0 <= --job-index < --job-count");
+
+  if (config.adaptive.empty())
+    return;
+  if (config.adaptive != "max_distance" && config.adaptive != "k_max" &&
+      config.adaptive != "entropy")
+    throw std::invalid_argument(
+        "--adaptive: expected max_distance, k_max or entropy");
+  if (config.triangleTargets.empty())
+    throw std::invalid_argument("--adaptive needs --triangles");
+  if (!config.betas.empty() && config.betas.size() < 2)
+    throw std::invalid_argument("--adaptive: --betas needs two values or more");
+  if (config.betaTolerance <= 0.0)
+    throw std::invalid_argument("--beta-tolerance must be > 0");
+  if (config.adaptiveSeeds < 2 || config.maxSeeds < config.adaptiveSeeds)
+    throw std::invalid_argument(
+        "need 2 <= --adaptive-seeds <= --max-seeds (error bars need 2 seeds)");
+  if (config.refinePoints < 1)
+    throw std::invalid_argument("--refine-points must be >= 1");
+  if (config.checkpointInterval > 0 || config.resume || config.jobCount > 1 ||
+      config.listJobs || config.eventLog)
+    throw std::invalid_argument(
+        "--adaptive chooses its runs as it goes: it cannot be combined with "
+        "checkpoints, sharding, --event-log or --list-jobs");
+}
+
+std::string usage() {
+  return "Usage: quantum_net [--config FILE] [options]\n"
+         "\n"
+         "Without --betas/--triangles the built-in campaign is run.\n"
+         "\n"
+         "  --statistics LIST      fermi,bose (default: both)\n"
+         "  --energy NAME          linear | quadratic (default: linear)\n"
+         "  --sampler NAME         tree | classes: link sampler (tree)\n"
+         "  --storage NAME         full | lean: lean keeps ~60 B per\n"
+         "                         triangle for 10M+ networks (full)\n"
+         "  --dimension D          2 | 3 | 4: glue triangles, tetrahedra or\n"
+         "                         4-simplices (2); --triangles then counts\n"
+         "                         D-simplices\n"
+         "  --betas LIST           inverse temperatures, e.g. 0.05,0.5,5\n"
+         "  --triangles LIST       triangle targets N, e.g. 2500,5000\n"
+         "  --seeds LIST           seed offsets (seed = 42 + offset)\n"
+         "  --trials K             same as --seeds 0,1000,...,(K-1)*1000\n"
+         "  --lambda L             Poisson mean of node energies (7)\n"
+         "  --metric-interval S    steps between metric rows (666)\n"
+         "  --output-dir DIR       where CSVs are written (raw_csv)\n"
+         "  --tag NAME             output prefix <statistics>_<NAME>\n"
+         "  --checkpoint-interval S  snapshot every S steps (0 = off)\n"
+         "  --resume               continue runs from their snapshots\n"
+         "  --event-log            log every growth step to <metrics>.qlog\n"
+         "                         for quantum_net_replay\n"
+         "  --louvain-restarts R   Louvain runs for the modularity (4,\n"
+         "                         0 = skip)\n"
+         "  --louvain-threads T    threads for those runs per job (1)\n"
+         "  --path-samples S       BFS roots for path length and diameter\n"
+         "                         (64, 0 = all nodes: exact)\n"
+         "  --path-threads T       threads for those BFS per job (1)\n"
+         "  --spectral             Laplacian spectrum, heat kernel and\n"
+         "                         spectral dimension of the final network\n"
+         "  --spectral-moments M   Chebyshev moments (400)\n"
+         "  --spectral-vectors R   random vectors for the trace (8)\n"
+         "  --spectral-threads T   threads for the mat-vecs per job (1)\n"
+         "  --percolation          giant component under random and\n"
+         "                         degree-targeted node removal\n"
+         "  --percolation-orders R  removal orders averaged per kind (16)\n"
+         "  --percolation-threads T  threads for those orders per job (1)\n"
+         "  --summary FILE         ensemble summary across seeds\n"
+         "                         (<output-dir>/summary.csv)\n"
+         "  --summary-only         no per-seed metrics CSVs\n"
+         "  --quantiles            add p05..p95 columns to the summary\n"
+         "  --adaptive METRIC      search β_c instead of running the grid:\n"
+         "                         max_distance | k_max | entropy\n"
+         "  --beta-tolerance T     width of the final β_c bracket (0.05)\n"
+         "  --adaptive-seeds S     seeds per new β and per increase (3)\n"
+         "  --max-seeds S          seeds per β at most (12)\n"
+         "  --refine-points P      new β per refinement of the bracket (3)\n"
+         "  --profile FILE         write per-phase timings (JSON) to FILE\n"
+         "  --compress-exports     gzip the edge list and node curvatures\n"
+         "                         (*.csv.gz; builds with zlib)\n"
+         "  --sync-output          write files on the job threads instead\n"
+         "                         of the background writer\n"
+         "  --telemetry FILE       rewrite live job progress to FILE\n"
+         "                         (Prometheus text format)\n"
+         "  --telemetry-interval S  seconds between rewrites (10)\n"
+         "  --threads T            worker threads (0 = all cores)\n"
+         "  --job-index I          run only jobs k with k % J == I ...\n"
+         "  --job-count J          ... to shard a campaign over J nodes\n"
+         "  --list-jobs            print the selected jobs and exit\n"
+         "  --help                 show this message\n";
+}
+
+void applyRunSettings(const ExperimentConfig &config, SimulationJob &job) {
+  job.useQuadraticEnergy = config.energy == "quadratic";
+  job.useEnergyClasses = config.sampler == "classes";
+  job.leanStorage = config.storage == "lean";
+  job.dimension = config.dimension;
+  job.lambda = config.lambda;
+  job.metricInterval = config.metricInterval;
+  job.louvainRestarts = config.louvainRestarts;
+  job.louvainThreads = config.louvainThreads;
+  job.pathSamples = config.pathSamples;
+  job.pathThreads = config.pathThreads;
+  job.spectral = config.spectral;
+  job.spectralMoments = config.spectralMoments;
+  job.spectralVectors = config.spectralVectors;
+  job.spectralThreads = config.spectralThreads;
+  job.percolation = config.percolation;
+  job.percolationOrders = config.percolationOrders;
+  job.percolationThreads = config.percolationThreads;
+  if (!config.spectral) {
+    job.spectralDensityFile.clear();
+    job.heatKernelFile.clear();
+    job.lowEigenvaluesFile.clear();
+  }
+  if (!config.percolation)
+    job.percolationFile.clear();
+  if (config.dimension != 2) {
+    // Histograms and hops need the d = 2 Metrics
+    job.degreeHistogramFile.clear();
+    job.curvatureHistogramFile.clear();
+    job.hopsFile.clear();
+  }
+  if (config.compressExports) {
+    // The two exports that grow with N; FileSink gzips *.gz
+    for (std::string *path : {&job.edgesFile, &job.curvatureFile}) {
+      if (!path->empty())
+        *path += ".gz";
+    }
+  }
+}
+
+std::vector<SimulationJob> buildJobs(const ExperimentConfig &config) {
+  std::vector<SimulationJob> jobs;
+  auto append = [&jobs](const std::vector<SimulationJob> &more) {
+    jobs.insert(jobs.end(), more.begin(), more.end());
+  };
+
+  bool quadratic = config.energy == "quadratic";
+  auto prefixFor = [&config](const std::string &statistics,
+                             const std::string &suffix) {
+    std::string prefix = statistics;
+    if (!suffix.empty())
+      prefix += "_" + suffix;
+    if (config.dimension != 2)
+      prefix += "_d" + std::to_string(config.dimension);
+    if (!config.tag.empty())
+      prefix += "_" + config.tag;
+    return prefix;
+  };
+
+  if (config.betas.empty()) {
+    // Built-in campaign: single 100k runs, error-bar sweeps, time series
+    std::vector<double> betaValues = {0.01, 0.02, 0.03, 0.04, 0.05, 0.07, 0.1,
+                                      0.2,  0.3,  0.5,  0.7,  0.9,  1.0,  2.0,
+                                      3.0,  4.0,  5.0,  6.0,  7.0};
+    std::vector<int> triangleTargets = {2500, 5000, 10000};
+    std::vector<double> timeBeta = {0.05, 5.0};
+    std::vector<double> singleBeta = {0.05, 0.5, 5.0};
+
+    for (const std::string &name : config.statistics) {
+      for (double beta : singleBeta)
+        jobs.push_back(makeSingleRunJob(name == "bose", quadratic,
+                                        prefixFor(name, ""), beta, 100000,
+                                        config.outputDir));
+    }
+
+    for (int seedOffset : config.seedOffsets) {
+      for (const std::string &name : config.statistics)
+        append(makeBetaSweepJobs(name == "bose", betaValues, triangleTargets,
+                                 prefixFor(name, ""), seedOffset,
+                                 config.outputDir));
+      for (const std::string &name : config.statistics)
+        append(makeBetaSweepJobs(name == "bose", timeBeta, {10000},
+                                 prefixFor(name, "time"), seedOffset,
+                                 config.outputDir));
+    }
+
+    // 🚀 Single realization for N = 100000 (Fermi + Bose)
+    for (const std::string &name : config.statistics)
+      append(makeBetaSweepJobs(name == "bose", singleBeta, {100000},
+                               prefixFor(name, ""), 0, config.outputDir));
+  } else {
+    for (int seedOffset : config.seedOffsets) {
+      for (const std::string &name : config.statistics)
+        append(makeBetaSweepJobs(name == "bose", config.betas,
+                                 config.triangleTargets, prefixFor(name, ""),
+                                 seedOffset, config.outputDir));
+    }
+  }
+
+  for (SimulationJob &job : jobs)
+    applyRunSettings(config, job);
+
+  dropOverwrittenOutputs(jobs); // trials share curvature/edges file names
+
+  for (SimulationJob &job : jobs) {
+    // A run whose metrics file another job overwrites is a duplicate
+    // configuration: it must not be counted twice in the summary either
+    job.summarize = !job.metricsFile.empty();
+    if (config.summaryOnly)
+      job.metricsFile.clear();
+  }
+
+  for (SimulationJob &job : jobs) {
+    job.checkpointInterval = config.checkpointInterval;
+    job.resume = config.resume;
+    if (config.checkpointInterval > 0 || config.resume)
+      job.checkpointFile = defaultCheckpointFile(job);
+    if (config.eventLog)
+      job.eventLogFile = defaultEventLogFile(job);
+  }
+  return jobs;
+}
+
+std::string summaryFileName(const ExperimentConfig &config) {
+  if (!config.summaryFile.empty())
+    return config.summaryFile;
+  std::string name = "summary.csv";
+  if (config.jobCount > 1)
+    name = "summary_" + std::to_string(config.jobIndex) + "of" +
+           std::to_string(config.jobCount) + ".csv";
+  return (fs::path(config.outputDir) / name).string();
+}
+
+std::vector<SimulationJob> selectShard(const std::vector<SimulationJob> &jobs,
+                                       int jobIndex, int jobCount) {
+  std::vector<SimulationJob> shard;
+  for (std::size_t k = 0; k < jobs.size(); ++k) {
+    if ((int)(k % jobCount) == jobIndex)
+      shard.push_back(jobs[k]);
+  }
+  return shard;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "experiment.hpp"
+
+#include <string>
+#include <vector>
+
+// Experiment definition read from a config file and/or the command line, so
+// campaigns can be changed and sharded without recompiling quantum_net.
+//
+// Config files hold one `key = value` per line (`#` starts a comment); keys
+// are the long command-line options without the leading dashes, lists are
+// comma-separated. Command-line options override the config file.
+struct ExperimentConfig {
+  std::vector<std::string> statistics = {"fermi", "bose"};
+  std::string energy = "linear"; // linear | quadratic
+  std::string sampler = "tree";  // tree | classes (GrowthEngine mode)
+  std::string storage = "full";  // full | lean (NetworkStorage)
+  int dimension = 2;             // 2 = triangles, 3 or 4 (SimplicialNetwork)
+  std::vector<double> betas;     // empty: run the built-in campaign
+  std::vector<int> triangleTargets;
+  std::vector<int> seedOffsets = {0, 1000, 2000, 3000, 4000, 5000};
+  int lambda = 7;           // mean of the Poisson node energies
+  int metricInterval = 666; // steps between metric rows
+  std::string outputDir = "raw_csv";
+  std::string tag; // output prefix becomes <statistics>_<tag>
+  int checkpointInterval = 0; // steps between snapshots, 0 = off
+  bool resume = false;        // continue from existing snapshots
+  bool eventLog = false;      // write a growth event log per run
+  int louvainRestarts = 4;    // final modularity, 0 = skip
+  int louvainThreads = 1;     // threads per run for the restarts
+  int pathSamples = 64;      // BFS roots for path lengths, 0 = all
+  int pathThreads = 1;       // threads per run for those BFS
+  bool spectral = false;     // Laplacian spectrum and spectral dimension
+  int spectralMoments = 400; // KPM Chebyshev moments
+  int spectralVectors = 8;   // random vectors for the KPM trace
+  int spectralThreads = 1;   // threads per run for the mat-vecs
+  bool percolation = false;  // giant component under node removal
+  int percolationOrders = 16; // removal orders per kind
+  int percolationThreads = 1; // threads per run for the orders
+
+  bool compressExports = false; // edges and node curvatures as *.csv.gz
+  bool syncOutput = false;      // no AsyncWriter: job threads write files
+
+  std::string profileFile; // per-phase timings as JSON, empty = off
+  std::string telemetryFile;      // live progress (Telemetry), empty = off
+  double telemetryInterval = 10.0; // seconds between rewrites
+
+  // Adaptive β_c search (critical_search.hpp) instead of the β grid:
+  // order parameter max_distance | k_max | entropy, empty = off. --betas is
+  // the coarse starting grid, seeds are chosen by the search.
+  std::string adaptive;
+  double betaTolerance = 0.05; // final bracket width
+  int adaptiveSeeds = 3;       // seeds per new β, and per increase
+  int maxSeeds = 12;           // seeds per β at most
+  int refinePoints = 3;        // new β per refinement
+
+  // Ensemble summary across seeds (EnsembleAggregator); empty = the
+  // default summaryFileName() in outputDir
+  std::string summaryFile;
+  bool summaryOnly = false; // skip the per-seed metrics CSVs
+  bool quantiles = false;   // add p05..p95 columns to the summary
+
+  int threads = 0;  // 0 = hardware concurrency
+  int jobIndex = 0; // run jobs k with k % jobCount == jobIndex
+  int jobCount = 1;
+  bool listJobs = false; // print the selected jobs instead of running them
+  bool showHelp = false;
+};
+
+// Parses argv (loading --config first) and validates the result.
+// Throws std::invalid_argument on unknown keys or malformed values.
+ExperimentConfig parseCommandLine(int argc, char **argv);
+void loadConfigFile(const std::string &path, ExperimentConfig &config);
+void applyOption(ExperimentConfig &config, const std::string &key,
+                 const std::string &value);
+void validateConfig(const ExperimentConfig &config);
+
+std::string usage();
+
+// <outputDir>/summary.csv, or summary_<index>of<count>.csv for a shard
+std::string summaryFileName(const ExperimentConfig &config);
+
+// Copies the per-run settings (sampler, storage, metrics, ...) into a job
+void applyRunSettings(const ExperimentConfig &config, SimulationJob &job);
+
+// Expands the config into the full, de-duplicated job list (identical on
+// every shard), then keeps only this shard's slice.
+std::vector<SimulationJob> buildJobs(const ExperimentConfig &config);
+std::vector<SimulationJob> selectShard(const std::vector<SimulationJob> &jobs,
+                                       int jobIndex, int jobCount);
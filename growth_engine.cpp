@@ -1,7 +1,11 @@
 #include "growth_engine.hpp"
+#include "event_log.hpp"
+#include "profiler.hpp"
+#include <algorithm>
 #include <iostream> // for std::cout
 #include <numeric>
 #include <random>
+#include <sstream>
 #include <stdexcept> // for std::runtime_error
 #include <vector>
 
@@ -17,6 +21,7 @@ GrowthEngine::GrowthEngine(Network &network, int lambda)
 
 void GrowthEngine::setEnergySampler(std::function<int()> sampler) {
   energySampler = sampler;
+  customEnergySampler = true;
 }
 // 🎯 allows switching!
 // This function allows the user to set a custom energy sampling function
@@ -24,37 +29,107 @@ void GrowthEngine::setEnergySampler(std::function<int()> sampler) {
 // The default is a Poisson distribution with mean 5.
 // This can be replaced with any other sampling strategy.
 
+std::string GrowthEngine::saveState() const {
+  std::ostringstream out;
+  out << poissonDist; // mean and any cached normal variate
+  return out.str();
+}
+
+void GrowthEngine::loadState(const std::string &state) {
+  std::istringstream in(state);
+  in >> poissonDist;
+  if (!in)
+    throw std::runtime_error("Invalid GrowthEngine state.");
+}
+
+void GrowthEngine::setSamplingMode(SamplingMode newMode) {
+  mode = newMode;
+  if (mode == SamplingMode::EnergyClasses)
+    classSampler = std::make_unique<EnergyClassSampler>(net);
+  else
+    classSampler.reset();
+}
+
+void GrowthEngine::reserveSteps(int steps) {
+  int needed = net.numTriangles() + steps;
+  if (needed > net.reservedTriangles())
+    net.reserve(std::max(needed, 2 * net.numTriangles()));
+}
+
+void GrowthEngine::growSteps(int steps) {
+  reserveSteps(steps);
+  for (int s = 0; s < steps; ++s)
+    growOneStep();
+}
+
+template <class Statistics, class Energy>
+void GrowthEngine::growSteps(int steps, const Statistics &statistics,
+                             const Energy &energy) {
+  reserveSteps(steps);
+  auto drawEnergy = [this]() {
+    return customEnergySampler ? energySampler() : poissonDist(net.rng);
+  };
+  for (int s = 0; s < steps; ++s)
+    step(statistics, energy, drawEnergy);
+}
+
 void GrowthEngine::growOneStep() {
-  std::vector<std::pair<std::pair<int, int>, double>> probabilities;
-  double Z = 0.0;
-
-  for (const auto &[key, link] : net.links) {
-    if (!link.isSaturated(net.m)) {
-      double w = std::exp(-net.beta * link.energy) * (1 + link.numTriangles);
-      probabilities.emplace_back(key, w);
-      Z += w;
-    }
-  }
+  step(RuntimeStatistics{net.m}, RuntimeEnergy{&net}, energySampler);
+}
+
+template <class Statistics, class Energy, class EnergyDraw>
+void GrowthEngine::step(const Statistics &statistics, const Energy &energy,
+                        EnergyDraw &&drawEnergy) {
+  // Z = Σ e^{-βε}(1+n) over unsaturated links, maintained incrementally
+  // (relative to the lowest energy level for EnergyClasses)
+  double Z = classSampler ? classSampler->total() : net.sampler.total();
 
-  if (Z == 0.0 || probabilities.empty()) {
+  if (Z == 0.0 || net.numLinks() == 0) {
     std::cout << "⚠️ No valid links available for growth (Z = 0). Hanging "
                  "prevented.\n";
     throw std::runtime_error("No possible growth steps (Z = 0).");
   }
 
-  // Create a discrete distribution
-  std::vector<double> weights;
-  for (const auto &p : probabilities)
-    weights.push_back(p.second);
-
-  std::discrete_distribution<> dist(weights.begin(), weights.end());
-
-  // Select a link to attach a new triangle
-  int idx = dist(net.rng);
-  auto [i, j] = probabilities[idx].first;
+  // Select a link to attach a new triangle, P(ij) ∝ e^{-βε_ij}(1+n_ij)
+  int k;
+  {
+    ProfileScope scope(ProfilePhase::SampleLink);
+    k = classSampler ? classSampler->sample(net.rng)
+                     : net.sampler.sample(net.rng);
+  }
 
   // Create a new node with random energy ω
-  int ω = energySampler();      // 🔁 uses current sampler
+  int ω = drawEnergy();         // 🔁 uses current sampler
   int newNode = net.addNode(ω); // 🎯 Add new node to the network
-  net.addTriangle(i, j, newNode);
-}
\ No newline at end of file
+  net.attachTriangle(k, newNode, statistics, energy);
+  if (eventLog)
+    eventLog->append(k, ω);
+}
+
+template void GrowthEngine::growSteps(int, const FermiDirac<2> &,
+                                      const LinearEnergy &);
+template void GrowthEngine::growSteps(int, const FermiDirac<2> &,
+                                      const QuadraticEnergy &);
+template void GrowthEngine::growSteps(int, const BoseEinstein &,
+                                      const LinearEnergy &);
+template void GrowthEngine::growSteps(int, const BoseEinstein &,
+                                      const QuadraticEnergy &);
+
+namespace {
+template <class Statistics, class Energy>
+void runKernel(GrowthEngine &engine, int steps) {
+  engine.growSteps(steps, Statistics{}, Energy{});
+}
+
+void runGeneric(GrowthEngine &engine, int steps) { engine.growSteps(steps); }
+} // namespace
+
+GrowthKernel selectGrowthKernel(int m, bool quadraticEnergy) {
+  if (m == FermiDirac<2>::maxTriangles)
+    return quadraticEnergy ? runKernel<FermiDirac<2>, QuadraticEnergy>
+                           : runKernel<FermiDirac<2>, LinearEnergy>;
+  if (m == BoseEinstein::maxTriangles)
+    return quadraticEnergy ? runKernel<BoseEinstein, QuadraticEnergy>
+                           : runKernel<BoseEinstein, LinearEnergy>;
+  return runGeneric;
+}
@@ -1,6 +1,19 @@
 #pragma once
+#include "energy_class_sampler.hpp"
 #include "network.hpp"
 
+#include <memory>
+#include <string>
+
+class EventLogWriter;
+
+// How growOneStep picks the link a new triangle attaches to. Both draw from
+// P(ij) ∝ e^{-βε_ij}(1+n_ij); they use the rng differently.
+enum class SamplingMode {
+  LinkTree,     // Network::sampler, one segment tree over all links
+  EnergyClasses // EnergyClassSampler: energy level first, then a link
+};
+
 // Class responsible for growing the network by adding triangles
 class GrowthEngine {
 public:
@@ -9,11 +22,56 @@ public:
 
   // Performs one step of growth by adding a triangle
   void growOneStep();
+
+  // Performs `steps` growth steps, preallocating the network storage once.
+  // Throws like growOneStep if growth stops (Z = 0).
+  void growSteps(int steps);
+
+  // Same loop with m and the energy function fixed at compile time, and
+  // the Poisson energies drawn directly unless setEnergySampler was used.
+  // Statistics and Energy must describe the network (see
+  // selectGrowthKernel); the trajectory is then identical to growSteps.
+  template <class Statistics, class Energy>
+  void growSteps(int steps, const Statistics &statistics,
+                 const Energy &energy);
+
+  // Switches the link sampler. Call after the network is initialized or
+  // loaded from a snapshot; EnergyClasses indexes the links present then.
+  void setSamplingMode(SamplingMode mode);
+  SamplingMode samplingMode() const { return mode; }
   void setEnergySampler(std::function<int()> sampler); // 🎯 allows switching!
+  // Appends every following step (link, ω) to log; nullptr = off, not owned
+  void setEventLog(EventLogWriter *log) { eventLog = log; }
+
+  // State of the default Poisson sampler, for checkpoints (a custom sampler
+  // set with setEnergySampler must restore its own state)
+  std::string saveState() const;
+  void loadState(const std::string &state);
 
 private:
   Network &net; // Reference to the network being grown
   std::poisson_distribution<int>
       poissonDist;                    // Poisson distribution for random growth
   std::function<int()> energySampler; // 🧠 dynamic sampler
-};
\ No newline at end of file
+  bool customEnergySampler = false;   // set by setEnergySampler
+  EventLogWriter *eventLog = nullptr; // set by setEventLog
+
+  SamplingMode mode = SamplingMode::LinkTree;
+  std::unique_ptr<EnergyClassSampler> classSampler; // EnergyClasses only
+
+  // Makes room for `steps` more triangles. A short capacity is at least
+  // doubled, so growing in many small calls does not reallocate each time.
+  void reserveSteps(int steps);
+
+  // One growth step; every public step function is an instance of this
+  template <class Statistics, class Energy, class EnergyDraw>
+  void step(const Statistics &statistics, const Energy &energy,
+            EnergyDraw &&drawEnergy);
+};
+
+// Picks the growth loop compiled for a configuration: Fermi-Dirac with
+// m = 2 or Bose-Einstein (m = INT_MAX), with the linear or quadratic energy
+// of growth_policies.hpp. Other m use the generic growSteps. The network
+// must have been built with the matching energy function.
+using GrowthKernel = void (*)(GrowthEngine &engine, int steps);
+GrowthKernel selectGrowthKernel(int m, bool quadraticEnergy);
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <climits>
+#include <cmath>
+#include <vector>
+
+class Network;
+
+// Compile-time descriptions of the growth rule, used to instantiate the
+// growth loop without std::function calls or dead saturation checks
+// (Network::addTriangle and GrowthEngine::growSteps overloads).
+
+// Fermi-Dirac: a link holds at most M triangles
+template <int M> struct FermiDirac {
+  static constexpr int maxTriangles = M;
+  bool saturated(int numTriangles) const { return numTriangles >= M; }
+};
+
+// Bose-Einstein: links never saturate
+struct BoseEinstein {
+  static constexpr int maxTriangles = INT_MAX;
+  bool saturated(int) const { return false; }
+};
+
+// Any m, read from the network at run time
+struct RuntimeStatistics {
+  int maxTriangles;
+  bool saturated(int numTriangles) const {
+    return numTriangles >= maxTriangles;
+  }
+};
+
+// ε_ij = ω_i + ω_j
+struct LinearEnergy {
+  double operator()(int omega_i, int omega_j) const {
+    return static_cast<double>(omega_i + omega_j);
+  }
+};
+
+// ε_ij = J(J+1), J = (ω_i + ω_j) / 2
+struct QuadraticEnergy {
+  double operator()(int omega_i, int omega_j) const {
+    double J = (omega_i + omega_j) / 2.0;
+    return J * (J + 1.0);
+  }
+};
+
+// The network's own std::function energy
+struct RuntimeEnergy {
+  Network *net;
+  double operator()(int omega_i, int omega_j) const;
+};
+
+// Cached e^{-βε} for the integer energies ε = 0..4096 (others are computed
+// on the fly); the table is refilled when β changes. Network,
+// SimplicialNetwork and ReplicaEnsemble all look their factors up here, so
+// their growth weights are the same doubles.
+class BoltzmannFactors {
+public:
+  double operator()(double beta, int energy) {
+    if (beta != tableBeta) {
+      table.clear();
+      tableBeta = beta;
+    }
+    if (energy < 0 || energy > 4096)
+      return std::exp(-beta * energy); // not worth a table entry
+    while ((int)table.size() <= energy)
+      table.push_back(std::exp(-beta * static_cast<int>(table.size())));
+    return table[energy];
+  }
+
+private:
+  std::vector<double> table; // e^{-βε} for ε = 0, 1, 2, ...
+  double tableBeta = 0.0;    // β the table was computed for
+};
+
+// Growth weight e^{-βε}(1+n) of a link or face holding n simplices, 0 once
+// saturated under `statistics`
+template <class Statistics>
+double attachmentWeight(const Statistics &statistics,
+                        BoltzmannFactors &factors, double beta, int energy,
+                        int n) {
+  if (statistics.saturated(n))
+    return 0.0;
+  return factors(beta, energy) * (1 + n);
+}
@@ -0,0 +1,112 @@
+#include "link_sampler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+int LinkSampler::add(double weight) {
+  if (count == capacity)
+    grow(capacity > 0 ? 2 * capacity : 16);
+
+  int index = count++;
+  update(index, weight);
+  return index;
+}
+
+void LinkSampler::update(int index, double weight) {
+  int node = capacity + index;
+  if (!leafWeight)
+    tree[node] = weight;
+
+  // Recompute the sums from the children (no drift from +=/-= deltas)
+  for (node /= 2; node >= 1; node /= 2) {
+    if (node < stored)
+      tree[node] = value(2 * node) + value(2 * node + 1);
+  }
+}
+
+double LinkSampler::value(int node) const {
+  if (node < stored)
+    return tree[node];
+  if (node < capacity) // parent of two leaves, not stored
+    return value(2 * node) + value(2 * node + 1);
+  int index = node - capacity;
+  return index < count ? leafWeight(index) : 0.0;
+}
+
+double LinkSampler::weight(int index) const { return value(capacity + index); }
+
+double LinkSampler::total() const { return capacity > 0 ? tree[1] : 0.0; }
+
+int LinkSampler::size() const { return count; }
+
+void LinkSampler::clear() {
+  capacity = 0;
+  count = 0;
+  stored = 0;
+  tree.clear();
+}
+
+void LinkSampler::reserve(int numLinks) {
+  int newCapacity = capacity > 0 ? capacity : 16;
+  while (newCapacity < numLinks)
+    newCapacity *= 2;
+  if (newCapacity != capacity)
+    grow(newCapacity);
+}
+
+void LinkSampler::assign(const std::vector<double> &weights) {
+  count = static_cast<int>(weights.size());
+  capacity = 16;
+  while (capacity < count)
+    capacity *= 2;
+
+  stored = leafWeight ? capacity / 2 : 2 * capacity;
+  tree.assign(stored, 0.0);
+  if (!leafWeight)
+    std::copy(weights.begin(), weights.end(), tree.begin() + capacity);
+  for (int node = std::min(stored, capacity) - 1; node >= 1; --node)
+    tree[node] = value(2 * node) + value(2 * node + 1);
+}
+
+int LinkSampler::sample(std::mt19937 &rng) const {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double u = uniform(rng) * tree[1];
+
+  int node = 1;
+  while (node < capacity) {
+    int left = 2 * node;
+    double leftWeight = value(left);
+    // Never descend into an empty subtree, even if rounding pushes u past it
+    if (u < leftWeight || value(left + 1) == 0.0) {
+      node = left;
+    } else {
+      u -= leftWeight;
+      node = left + 1;
+    }
+  }
+
+  return node - capacity;
+}
+
+void LinkSampler::setLeafWeights(std::function<double(int)> weightOf) {
+  leafWeight = std::move(weightOf);
+  clear();
+}
+
+void LinkSampler::grow(int newCapacity) {
+  std::vector<double> oldTree;
+  oldTree.swap(tree);
+  int oldCapacity = capacity;
+
+  // The old tree is the left subtree of the new one: move the leaves over
+  // (if stored) and rebuild the sums
+  capacity = newCapacity;
+  stored = leafWeight ? capacity / 2 : 2 * capacity;
+  tree.assign(stored, 0.0);
+  if (!leafWeight) {
+    for (int k = 0; k < count; ++k)
+      tree[capacity + k] = oldTree[oldCapacity + k];
+  }
+  for (int node = std::min(stored, capacity) - 1; node >= 1; --node)
+    tree[node] = value(2 * node) + value(2 * node + 1);
+}
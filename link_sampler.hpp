@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <random>
+#include <vector>
+
+// Incremental weighted sampler over a dense link index.
+// Leaves of a segment tree hold the growth weight of each link and every
+// internal node stores the sum of its two children, so changing one weight
+// or drawing a link costs O(log L) instead of a full rescan.
+class LinkSampler {
+public:
+  int add(double weight);                // appends a link, returns its index
+  void update(int index, double weight); // sets the weight of link `index`
+  double weight(int index) const;        // current weight of link `index`
+  double total() const;                  // Z = Σ w over all links
+  int size() const;                      // number of indexed links
+  void clear();
+  void reserve(int numLinks); // grows the tree once for numLinks leaves
+  std::size_t bytes() const { return tree.capacity() * sizeof(double); }
+
+  // Replaces all weights at once in O(L); the tree is identical to the one
+  // built by calling add() for each weight in order
+  void assign(const std::vector<double> &weights);
+
+  // Draws an index with probability weight / total(). Requires total() > 0.
+  int sample(std::mt19937 &rng) const;
+
+  // Stops storing the leaves and their parents, a quarter of the tree:
+  // their values are recomputed from weightOf(index), which must return the
+  // current weight of that link (the one passed to add/update/assign).
+  // Sums, summation order and draws are the same as with stored leaves.
+  // Clears the sampler.
+  void setLeafWeights(std::function<double(int)> weightOf);
+
+private:
+  int capacity = 0;         // number of leaves (power of two)
+  int count = 0;            // number of leaves in use
+  int stored = 0;           // tree[node] is kept for node < stored
+  std::vector<double> tree; // tree[1] = root, leaves at [capacity, 2*capacity)
+  std::function<double(int)> leafWeight; // set: stored = capacity / 2
+
+  double value(int node) const; // tree[node], or recomputed if not stored
+
+  // Moves the leaves into a larger power-of-two tree and rebuilds the sums;
+  // the old tree is its left subtree, so draws do not depend on capacity
+  void grow(int newCapacity);
+};
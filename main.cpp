@@ -1,189 +1,134 @@
-#include "growth_engine.hpp"
-#include "metrics.hpp"
-#include "network.hpp"
-
+#include "async_writer.hpp"
+#include "critical_search.hpp"
+#include "ensemble.hpp"
+#include "experiment.hpp"
+#include "experiment_config.hpp"
+#include "profiler.hpp"
+#include "sweep_scheduler.hpp"
+#include "telemetry.hpp"
+
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <limits>
-
-#define ERROR_BAR_TRIALS 6
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace fs = std::filesystem;
 
-void run_simulation(bool isBose, bool useQuadraticEnergy,
-                    const std::string &outputPrefix, double betaVal) {
-  int m = isBose ? std::numeric_limits<int>::max() : 2;
-
-  auto linearEnergy = [](int omega_i, int omega_j) {
-    return static_cast<double>(omega_i + omega_j);
-  };
-
-  auto quadraticEnergy = [](int omega_i, int omega_j) {
-    double J = (omega_i + omega_j) / 2.0;
-    return J * (J + 1.0);
-  };
-
-  auto selectedEnergy = useQuadraticEnergy ? quadraticEnergy : linearEnergy;
-  std::string phase = isBose ? "Bose-Einstein" : "Fermi-Dirac";
-
-  Network net(42, m, betaVal, selectedEnergy);
-  net.initialize();
-  GrowthEngine engine(net, 7);
-
-  fs::path outputDir = fs::current_path() / "raw_csv";
-  fs::create_directories(outputDir);
-
-  std::ostringstream oss;
-  oss << std::fixed << std::setprecision(2) << betaVal;
-  std::string betaFormatted = oss.str();
-  std::replace(betaFormatted.begin(), betaFormatted.end(), '.', '_');
-
-  std::string baseName =
-      outputPrefix + "_beta" + betaFormatted + "_N100000_seed0";
-
-  fs::path metricsFile = outputDir / (baseName + ".csv");
-  fs::path edgesFile = outputDir / (baseName + "_edges.csv");
-  fs::path curvatureFile = outputDir / (baseName + "_curvature_nodes.csv");
-
-  std::ofstream out(metricsFile);
-  out << "step,max_distance,k_max,entropy\n";
-
-  int steps = 0;
-
-  while ((int)net.triangles.size() < 100000) {
-    try {
-      engine.growOneStep(); // ✅ wrapped properly
-    } catch (const std::runtime_error &e) {
-      std::cerr << "❌ ERROR during growth: " << e.what() << "\n";
-      break; // Don't exit(1); just stop this simulation
-    }
-
-    if (steps % 666 == 0) {
-      int d = Metrics::maxDistanceFromInitialTriangle(net);
-      int k = Metrics::maxDegree(net);
-      double H = Metrics::entropyRate(net);
-      out << steps << "," << d << "," << k << "," << H << "\n";
-    }
-
-    steps++;
+int main(int argc, char **argv) {
+  ExperimentConfig config;
+  try {
+    config = parseCommandLine(argc, argv);
+  } catch (const std::invalid_argument &e) {
+    std::cerr << "❌ " << e.what() << "\n\n" << usage();
+    return 1;
   }
 
-  out.close();
-
-  net.exportEdgeList(edgesFile.string());
-  net.exportNodeCurvatures(curvatureFile.string());
-
-  std::cout << "[" << phase << "] β=" << betaVal
-            << ", Nodes=" << net.nodes.size()
-            << ", Triangles=" << net.triangles.size() << ", steps=" << steps
-            << "\nExported to: " << metricsFile.filename() << ", "
-            << edgesFile.filename() << ", " << curvatureFile.filename()
-            << std::endl;
-}
-
-void run_beta_sweep(bool isBose, const std::vector<double> &betas,
-                    const std::vector<int> &triangleTargets,
-                    const std::string &outputPrefix, int seedOffset = 0) {
-  auto linearEnergy = [](int omega_i, int omega_j) {
-    return static_cast<double>(omega_i + omega_j);
-  };
-
-  std::string phase = isBose ? "Bose-Einstein" : "Fermi-Dirac";
-
-  for (double beta : betas) {
-    for (int N : triangleTargets) {
-      Network net(42 + seedOffset, isBose ? std::numeric_limits<int>::max() : 2,
-                  beta, linearEnergy);
-      net.initialize();
-      GrowthEngine engine(net, 7);
-
-      int step = 0;
-      std::ostringstream oss;
-      oss << std::fixed << std::setprecision(2) << beta;
-      std::string betaFormatted = oss.str();
-      std::replace(betaFormatted.begin(), betaFormatted.end(), '.', '_');
-
-      fs::path outputDir = fs::current_path();
-      fs::create_directories(outputDir / "raw_csv");
-
-      fs::path tag =
-          outputDir / "raw_csv" /
-          (outputPrefix + "_beta" + betaFormatted + "_N" + std::to_string(N) +
-           "_seed" + std::to_string(seedOffset) + ".csv");
-
-      std::cout << "📁 Writing to: " << tag << std::endl;
-      std::ofstream out(tag);
-      out << "step,max_distance,k_max,entropy\n";
-
-      while ((int)net.triangles.size() < N) {
-        try {
-          engine.growOneStep(); // ✅ Only one, properly wrapped
-        } catch (const std::runtime_error &e) {
-          std::cout << "❌ ERROR during growth: " << e.what() << "\n";
-          break;
-        }
-
-        if (step % 666 == 0) {
-          int d = Metrics::maxDistanceFromInitialTriangle(net);
-          int k = Metrics::maxDegree(net);
-          double H = Metrics::entropyRate(net);
-          out << step << "," << d << "," << k << "," << H << "\n";
-        }
-        step++;
-      }
-
-      out.close();
-
-      std::string nodeCurvFile =
-          (outputDir / "raw_csv" /
-           (outputPrefix + "_beta" + betaFormatted + "_N" + std::to_string(N) +
-            "_curvature_nodes.csv"))
-              .string();
-      net.exportNodeCurvatures(nodeCurvFile);
+  if (config.showHelp) {
+    std::cout << usage();
+    return 0;
+  }
 
-      std::string edgeFile = (outputDir / "raw_csv" /
-                              (outputPrefix + "_beta" + betaFormatted + "_N" +
-                               std::to_string(N) + "_edges.csv"))
-                                 .string();
-      net.exportEdgeList(edgeFile);
+  std::vector<SimulationJob> allJobs;
+  std::vector<SimulationJob> jobs;
+  if (config.adaptive.empty()) {
+    allJobs = buildJobs(config);
+    jobs = selectShard(allJobs, config.jobIndex, config.jobCount);
+  }
 
-      std::cout << "[" << phase << "] β=" << beta << ", N=" << N
-                << ", steps=" << step << ", Nodes=" << net.nodes.size() << "\n";
+  if (config.listJobs) {
+    for (const SimulationJob &job : jobs) {
+      std::cout << describeJob(job) << " -> "
+                << (job.metricsFile.empty() ? job.edgesFile : job.metricsFile)
+                << "\n";
     }
+    return 0;
   }
-}
-
-int main() {
-  fs::create_directories(fs::current_path() / "raw_csv");
-
-  run_simulation(false, false, "fermi", 0.05);
-  run_simulation(false, false, "fermi", 0.5);
-  run_simulation(false, false, "fermi", 5.0);
-  run_simulation(true, false, "bose", 0.05);
-  run_simulation(true, false, "bose", 0.5);
-  run_simulation(true, false, "bose", 5.0);
 
-  if (ERROR_BAR_TRIALS > 0) {
-    std::vector<double> betaValues = {0.01, 0.02, 0.03, 0.04, 0.05, 0.07, 0.1,
-                                      0.2,  0.3,  0.5,  0.7,  0.9,  1.0,  2.0,
-                                      3.0,  4.0,  5.0,  6.0,  7.0};
-    std::vector<int> triangleTargets = {2500, 5000, 10000};
-    std::vector<double> timeBeta = {0.05, 5.0};
+  try {
+    fs::create_directories(config.outputDir);
+  } catch (const fs::filesystem_error &e) {
+    std::cerr << "❌ Cannot create output directory " << config.outputDir
+              << ": " << e.code().message() << "\n";
+    return 1;
+  }
+  // Files are written in the background, so jobs never wait for the disk
+  if (!config.syncOutput)
+    AsyncWriter::start();
+
+  std::unique_ptr<Telemetry> telemetry;
+  if (!config.telemetryFile.empty())
+    telemetry = std::make_unique<Telemetry>(config.telemetryFile,
+                                            config.telemetryInterval);
+
+  EnsembleAggregator ensemble(config.quantiles);
+  SweepScheduler scheduler(config.threads);
+  for (const SimulationJob &job : jobs) {
+    if (job.summarize) // folded in seed order as the runs finish
+      ensemble.expectRun(job.series, job.beta, job.targetTriangles, job.seed);
+    JobProgress *progress = telemetry ? telemetry->addJob(job) : nullptr;
+    scheduler.addJob(job.targetTriangles, [job, &ensemble, progress]() {
+      runJob(job, &ensemble, progress);
+    }, describeJob(job));
+  }
 
-    for (int trial = 0; trial < ERROR_BAR_TRIALS; ++trial) {
-      run_beta_sweep(false, betaValues, triangleTargets, "fermi", trial * 1000);
-      run_beta_sweep(true, betaValues, triangleTargets, "bose", trial * 1000);
-      run_beta_sweep(false, timeBeta, {10000}, "fermi_time", trial * 1000);
-      run_beta_sweep(true, timeBeta, {10000}, "bose_time", trial * 1000);
+  Profiler::setEnabled(!config.profileFile.empty());
+  auto start = std::chrono::steady_clock::now();
+  if (telemetry) {
+    telemetry->start();
+    std::cout << "📡 Telemetry: " << config.telemetryFile << "\n";
+  }
+  std::size_t jobsRun = jobs.size();
+  // Failed jobs, and anything else that went wrong: reported at the end,
+  // after the summary and every queued file have been written
+  std::vector<std::string> errors;
+  try {
+    if (!config.adaptive.empty()) {
+      // The β_c search picks its runs round by round
+      jobsRun = runCriticalSearch(config, ensemble, telemetry.get());
+    } else {
+      std::cout << "🧵 Running " << jobs.size() << " of " << allJobs.size()
+                << " jobs (shard " << config.jobIndex << "/"
+                << config.jobCount << ") on " << scheduler.threads()
+                << " threads\n";
+      errors = scheduler.run();
     }
+  } catch (const std::exception &e) {
+    errors.push_back(e.what());
+  }
+  if (telemetry)
+    telemetry->stop(); // final state of every job
+  std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+  // The runs that finished are summarized even if others failed
+  std::string summaryFile = summaryFileName(config);
+  try {
+    ensemble.writeSummary(summaryFile);
+    std::cout << "📊 Summary of " << ensemble.runs() << " runs: "
+              << summaryFile << "\n";
+  } catch (const std::exception &e) {
+    errors.push_back(e.what());
   }
 
-  // 🚀 Single realization for N = 100000 (Fermi + Bose)
-  run_beta_sweep(false, {0.05, 0.5, 5.0}, {100000}, "fermi", 0); // Fermi-Dirac
-  run_beta_sweep(true, {0.05, 0.5, 5.0}, {100000}, "bose", 0); // Bose-Einstein
+  // Every queued file is written and closed before we report success
+  std::vector<std::string> writeErrors = AsyncWriter::stop();
+  errors.insert(errors.end(), writeErrors.begin(), writeErrors.end());
+  for (const std::string &error : errors)
+    std::cerr << "❌ " << error << "\n";
+
+  if (!config.profileFile.empty()) {
+    // Phase times are summed over all worker threads
+    std::ofstream profile(config.profileFile);
+    profile << "{\"wall_seconds\":" << wall.count()
+            << ",\"threads\":" << scheduler.threads()
+            << ",\"jobs\":" << jobsRun
+            << ",\"phases\":" << Profiler::toJson() << "}\n";
+    std::cout << "⏱️ Profile written to " << config.profileFile << "\n";
+  }
 
-  return 0;
+  return errors.empty() ? 0 : 1;
 }
 // This code simulates a quantum network with both Bose-Einstein and Fermi-Dirac
-// statistics.
\ No newline at end of file
+// statistics.
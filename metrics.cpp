@@ -1,79 +1,286 @@
 #include "metrics.hpp"
+#include "profiler.hpp"
 
 #include <cmath>
-#include <fstream>
+#include <algorithm>
 #include <map>
-#include <queue>
-#include <set>
 
 int Metrics::maxDistanceFromInitialTriangle(const Network &net) {
-  if (net.nodes.size() < 3)
-    return 0;
+  ProfileScope scope(ProfilePhase::Metrics);
+  return std::max(0, static_cast<int>(hopDistribution(net).size()) - 1);
+}
 
-  std::set<int> seed = {0, 1, 2};
-  std::map<int, int> minDistance;
+std::vector<long long> Metrics::hopDistribution(const Network &net) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  if (net.numNodes() < 3)
+    return {};
 
-  for (int s : seed) {
-    std::queue<std::pair<int, int>> q;
-    std::set<int> visited;
-    q.push({s, 0});
-    visited.insert(s);
+  DistanceGraph graph = distanceGraph(net);
+  BreadthFirstSearch bfs(graph);
+  bfs.run({0, 1, 2});
+  return bfs.levelSizes();
+}
 
-    while (!q.empty()) {
-      auto [node, dist] = q.front();
-      q.pop();
+int Metrics::maxDegree(const Network &net) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  int maxDeg = 0;
+  for (int i = 0; i < net.numNodes(); ++i) {
+    if (net.degree(i) > maxDeg)
+      maxDeg = net.degree(i);
+  }
+  return maxDeg;
+}
 
-      if (minDistance.find(node) == minDistance.end() ||
-          dist < minDistance[node]) {
-        minDistance[node] = dist;
-      }
+void CompensatedSum::add(double x) {
+  double t = sum + x;
+  if (std::abs(sum) >= std::abs(x))
+    compensation += (sum - t) + x;
+  else
+    compensation += (x - t) + sum;
+  sum = t;
+}
 
-      for (int neighbor : net.adjacencyList.at(node)) {
-        if (!visited.count(neighbor)) {
-          visited.insert(neighbor);
-          q.push({neighbor, dist + 1});
-        }
-      }
-    }
+EnergyLevelSums::Level &EnergyLevelSums::level(int energy) {
+  if (levels.empty()) {
+    minEnergy = energy;
+  } else if (energy < minEnergy) {
+    levels.insert(levels.begin(), minEnergy - energy, Level());
+    minEnergy = energy;
   }
+  int k = energy - minEnergy;
+  if (k >= (int)levels.size())
+    levels.resize(k + 1);
+  return levels[k];
+}
 
-  int maxDist = 0;
-  for (const auto &[node, dist] : minDistance) {
-    if (dist > maxDist)
-      maxDist = dist;
-  }
+void EnergyLevelSums::add(int energy, int multiplicity) {
+  Level &l = level(energy);
+  l.M += multiplicity;
+  l.L.add(multiplicity * std::log(static_cast<double>(multiplicity)));
+}
 
-  return maxDist;
+void EnergyLevelSums::remove(int energy, int multiplicity) {
+  Level &l = level(energy);
+  l.M -= multiplicity;
+  l.L.add(-multiplicity * std::log(static_cast<double>(multiplicity)));
 }
 
-int Metrics::maxDegree(const Network &net) {
-  int maxDeg = 0;
-  for (const auto &[nodeID, neighbors] : net.adjacencyList) {
-    if ((int)neighbors.size() > maxDeg)
-      maxDeg = neighbors.size();
+void EnergyLevelSums::clear() {
+  minEnergy = 0;
+  levels.clear();
+}
+
+double EnergyLevelSums::partitionFunction() const {
+  double Z = 0.0;
+  for (int k = 0; k < (int)levels.size(); ++k) {
+    if (levels[k].M > 0)
+      Z += std::exp(-beta * (minEnergy + k)) * levels[k].M;
   }
-  return maxDeg;
+  return Z;
+}
+
+double EnergyLevelSums::entropyRate() const {
+  // Weights are taken relative to the lowest occupied level ε0 (H does not
+  // change), so log Z and (Σ w log w) / Z stay O(1) and do not cancel.
+  int first = 0;
+  while (first < (int)levels.size() && levels[first].M <= 0)
+    first++;
+
+  double Z = 0.0;
+  double sumWLogW = 0.0;
+  for (int k = first; k < (int)levels.size(); ++k) {
+    const Level &l = levels[k];
+    if (l.M <= 0)
+      continue;
+    double βΔε = beta * (k - first);
+    double f = std::exp(-βΔε);
+    Z += f * l.M;
+    sumWLogW += f * (l.L.value() - βΔε * l.M);
+  }
+
+  if (Z == 0.0)
+    return 0.0;
+  return std::log(Z) - sumWLogW / Z;
 }
 
 double Metrics::entropyRate(const Network &net) {
-  std::vector<double> weights;
+  ProfileScope scope(ProfilePhase::Metrics);
+  EnergyLevelSums sums(net.beta);
 
-  for (const auto &[key, link] : net.links) {
-    if (!link.isSaturated(net.m)) {
-      double w = std::exp(-net.beta * link.energy) * (1 + link.numTriangles);
-      weights.push_back(w);
-    }
+  for (const Link &link : net.getLinks()) {
+    if (!link.isSaturated(net.m))
+      sums.add(link.energy, 1 + link.numTriangles);
+  }
+
+  return sums.entropyRate();
+}
+
+std::vector<double> Metrics::localClustering(const Network &net) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  std::vector<double> C(net.numNodes(), 0.0);
+  for (int i = 0; i < (int)C.size(); ++i) {
+    double k = net.degree(i);
+    if (k >= 2)
+      C[i] = 2.0 * net.triangleCount(i) / (k * (k - 1.0));
   }
+  return C;
+}
 
-  double Z = std::accumulate(weights.begin(), weights.end(), 0.0);
-  if (Z == 0.0 || weights.empty())
+double Metrics::averageClustering(const Network &net) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  std::vector<double> C = localClustering(net);
+  if (C.empty())
     return 0.0;
 
-  double entropy = 0.0;
-  for (double w : weights) {
-    double p = w / Z;
-    entropy -= p * std::log(p);
+  double sum = 0.0;
+  for (double c : C)
+    sum += c;
+  return sum / C.size();
+}
+
+std::vector<DegreeBin> Metrics::degreeHistogram(const Network &net) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  std::vector<double> C = localClustering(net);
+  std::vector<DegreeBin> bins(maxDegree(net) + 1);
+  for (int i = 0; i < (int)C.size(); ++i) {
+    DegreeBin &bin = bins[net.degree(i)];
+    bin.count++;
+    bin.avgClustering += C[i];
+  }
+
+  std::vector<DegreeBin> histogram;
+  for (int k = 0; k < (int)bins.size(); ++k) {
+    if (bins[k].count == 0)
+      continue;
+    bins[k].k = k;
+    bins[k].avgClustering /= bins[k].count;
+    histogram.push_back(bins[k]);
+  }
+  return histogram;
+}
+
+std::vector<CurvatureBin> Metrics::curvatureHistogram(const Network &net) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  // Bin on the exact integer 6R = 6 - 3k + 2T
+  std::map<long long, long long> counts;
+  for (int i = 0; i < net.numNodes(); ++i)
+    counts[6 - 3LL * net.degree(i) + 2LL * net.triangleCount(i)]++;
+
+  std::vector<CurvatureBin> histogram;
+  for (const auto &[sixR, count] : counts) {
+    CurvatureBin bin;
+    bin.curvature = sixR / 6.0;
+    bin.count = count;
+    histogram.push_back(bin);
+  }
+  return histogram;
+}
+
+CommunityGraph Metrics::communityGraph(const Network &net) {
+  int n = net.numNodes();
+  CommunityGraph g;
+  g.offsets.assign(n + 1, 0);
+  g.selfLoop.assign(n, 0.0);
+  g.strength.resize(n);
+
+  for (int i = 0; i < n; ++i) {
+    g.offsets[i + 1] = g.offsets[i] + net.degree(i);
+    g.strength[i] = net.degree(i);
+  }
+  g.targets.reserve(g.offsets[n]);
+  for (int i = 0; i < n; ++i)
+    g.targets.insert(g.targets.end(), net.neighbors(i).begin(),
+                     net.neighbors(i).end());
+  g.weights.assign(g.targets.size(), 1.0);
+
+  return g;
+}
+
+CommunityResult Metrics::louvain(const Network &net, int restarts,
+                                 int threads, unsigned seed) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  return Louvain::run(communityGraph(net), restarts, threads, seed);
+}
+
+double Metrics::modularity(const Network &net,
+                           const std::vector<int> &community) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  return Louvain::modularity(communityGraph(net), community);
+}
+
+DistanceGraph Metrics::distanceGraph(const Network &net) {
+  int n = net.numNodes();
+  DistanceGraph g;
+  g.offsets.assign(n + 1, 0);
+  for (int i = 0; i < n; ++i)
+    g.offsets[i + 1] = g.offsets[i] + net.degree(i);
+  g.targets.reserve(g.offsets[n]);
+  for (int i = 0; i < n; ++i)
+    g.targets.insert(g.targets.end(), net.neighbors(i).begin(),
+                     net.neighbors(i).end());
+  return g;
+}
+
+PathLengthStats Metrics::pathLengths(const Network &net, int samples,
+                                     int threads, unsigned seed) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  return PathLengths::compute(distanceGraph(net), samples, threads, seed);
+}
+
+PercolationCurve Metrics::percolation(const Network &net, RemovalOrder order,
+                                      int orders, int threads,
+                                      unsigned seed) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  return Percolation::compute(distanceGraph(net), order, orders, threads,
+                              seed);
+}
+
+SparseLaplacian Metrics::laplacian(const Network &net, LaplacianKind kind) {
+  ProfileScope scope(ProfilePhase::Metrics);
+  int n = net.numNodes();
+
+  // Rows in BFS order from the seed triangle: neighbors get nearby indices,
+  // so the gathers of the mat-vec mostly hit cache. The spectrum does not
+  // depend on the numbering.
+  std::vector<int> order;
+  std::vector<int> row(n, -1);
+  order.reserve(n);
+  for (int root = 0; root < n; ++root) {
+    if (row[root] >= 0)
+      continue;
+    row[root] = static_cast<int>(order.size());
+    order.push_back(root);
+    for (std::size_t head = order.size() - 1; head < order.size(); ++head) {
+      for (int v : net.neighbors(order[head])) {
+        if (row[v] < 0) {
+          row[v] = static_cast<int>(order.size());
+          order.push_back(v);
+        }
+      }
+    }
   }
 
-  return entropy;
+  SparseLaplacian L;
+  L.kind = kind;
+  L.offsets.assign(n + 1, 0);
+  L.diagonal.resize(n);
+  L.scaling.resize(n);
+  for (int r = 0; r < n; ++r) {
+    int k = net.degree(order[r]);
+    L.offsets[r + 1] = L.offsets[r] + k;
+    if (kind == LaplacianKind::Normalized) {
+      L.diagonal[r] = k > 0 ? 1.0 : 0.0;
+      L.scaling[r] = k > 0 ? 1.0 / std::sqrt(static_cast<double>(k)) : 0.0;
+    } else {
+      L.diagonal[r] = k;
+      L.scaling[r] = 1.0;
+    }
+  }
+  L.targets.resize(L.offsets[n]);
+  for (int r = 0; r < n; ++r) {
+    int e = L.offsets[r];
+    for (int v : net.neighbors(order[r]))
+      L.targets[e++] = row[v];
+  }
+  return L;
 }
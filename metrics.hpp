@@ -1,9 +1,100 @@
 #pragma once
+#include "community.hpp"
+#include "distance.hpp"
+#include "percolation.hpp"
+#include "spectral.hpp"
 #include "network.hpp"
 
+#include <vector>
+
+// Neumaier-compensated running sum (tolerates adding and removing terms)
+struct CompensatedSum {
+  double sum = 0.0;
+  double compensation = 0.0;
+
+  void add(double x);
+  double value() const { return sum + compensation; }
+};
+
+// Z and Σ w·log w grouped by link energy. With x = 1 + n_ij,
+//   w = e^{-βε} x,  Σ_ε w = e^{-βε} M_ε,  Σ_ε w log w = e^{-βε}(-βε M_ε + L_ε)
+// where M_ε = Σ x is an exact integer and L_ε = Σ x log x. Links can be
+// added and removed without the cancellation a flat Σ w suffers at high β,
+// where the weights span hundreds of orders of magnitude.
+class EnergyLevelSums {
+public:
+  explicit EnergyLevelSums(double betaVal = 0.0) : beta(betaVal) {}
+
+  void add(int energy, int multiplicity);    // unsaturated link joins
+  void remove(int energy, int multiplicity); // unsaturated link leaves
+  void clear();
+
+  double partitionFunction() const; // Z = Σ w
+  double entropyRate() const;       // H = log Z - (Σ w log w) / Z
+
+private:
+  struct Level {
+    long long M = 0;  // Σ x
+    CompensatedSum L; // Σ x log x
+  };
+
+  double beta;
+  int minEnergy = 0;         // energy of levels[0]
+  std::vector<Level> levels; // levels[e - minEnergy]
+
+  Level &level(int energy); // creates missing levels on demand
+};
+
+struct DegreeBin {
+  int k = 0;
+  long long count = 0;        // nodes with degree k
+  double avgClustering = 0.0; // C(k)
+};
+
+struct CurvatureBin {
+  double curvature = 0.0; // R = 1 - k/2 + T/3
+  long long count = 0;
+};
+
 class Metrics {
 public:
   static int maxDistanceFromInitialTriangle(const Network &net);
+  // hops[d] = nodes at distance d from the seed triangle (nodes 0, 1, 2)
+  static std::vector<long long> hopDistribution(const Network &net);
   static int maxDegree(const Network &net);
   static double entropyRate(const Network &net);
+
+  // C_i = 2 T_i / (k_i (k_i - 1)), 0 for k_i < 2. Every node joins with
+  // exactly two neighbors, so the three corners of any graph triangle include
+  // the youngest node's two parents: graph triangles are exactly the glued
+  // triangles and T_i is Network::triangleCount(i), no neighbor scans needed.
+  static std::vector<double> localClustering(const Network &net);
+  static double averageClustering(const Network &net); // mean over all nodes
+
+  static std::vector<DegreeBin> degreeHistogram(const Network &net);
+  static std::vector<CurvatureBin> curvatureHistogram(const Network &net);
+
+  // Unweighted graph of the network for the community detection
+  static CommunityGraph communityGraph(const Network &net);
+  static CommunityResult louvain(const Network &net, int restarts = 4,
+                                 int threads = 1, unsigned seed = 42);
+  static double modularity(const Network &net,
+                           const std::vector<int> &community);
+
+  // Unweighted graph of the network for the distance computations
+  static DistanceGraph distanceGraph(const Network &net);
+  // Average shortest path and diameter from `samples` random roots (0 = all
+  // nodes, exact), see PathLengths
+  static PathLengthStats pathLengths(const Network &net, int samples = 0,
+                                     int threads = 1, unsigned seed = 42);
+  // Largest component under node removal, averaged over `orders` removal
+  // orders, see Percolation
+  static PercolationCurve percolation(const Network &net, RemovalOrder order,
+                                      int orders = 16, int threads = 1,
+                                      unsigned seed = 42);
+
+  // Graph Laplacian for the spectral analysis (spectral.hpp)
+  static SparseLaplacian
+  laplacian(const Network &net,
+            LaplacianKind kind = LaplacianKind::Normalized);
 };
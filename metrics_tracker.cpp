@@ -0,0 +1,63 @@
+#include "metrics_tracker.hpp"
+
+#include <algorithm>
+
+MetricsTracker::MetricsTracker(Network &network)
+    : net(network), sums(network.beta) {
+  rebuild();
+  net.addObserver(this);
+}
+
+MetricsTracker::~MetricsTracker() { net.removeObserver(this); }
+
+void MetricsTracker::rebuild() {
+  int n = net.numNodes();
+  kMax = 0;
+  sums = EnergyLevelSums(net.beta);
+
+  // Multi-source BFS from the seed triangle
+  std::vector<int> seeds;
+  for (int s = 0; s < std::min(n, 3); ++s) {
+    if (net.degree(s) > 0)
+      seeds.push_back(s);
+  }
+  DistanceGraph graph = Metrics::distanceGraph(net);
+  BreadthFirstSearch bfs(graph);
+  distance = bfs.run(seeds);
+  maxDist = std::max(0, bfs.eccentricity());
+
+  for (int i = 0; i < n; ++i)
+    kMax = std::max(kMax, net.degree(i));
+
+  for (const Link &link : net.getLinks()) {
+    if (!link.isSaturated(net.m))
+      sums.add(link.energy, 1 + link.numTriangles);
+  }
+}
+
+void MetricsTracker::onLinkUpdated(const Network &network, const Link &link,
+                                   int oldNumTriangles) {
+  if (oldNumTriangles > 0 && oldNumTriangles < network.m)
+    sums.remove(link.energy, 1 + oldNumTriangles);
+  if (!link.isSaturated(network.m))
+    sums.add(link.energy, 1 + link.numTriangles);
+}
+
+void MetricsTracker::onTriangleAdded(const Network &network, int i, int j,
+                                     int r) {
+  int top = std::max({i, j, r});
+  if ((int)distance.size() <= top)
+    distance.resize(top + 1, -1);
+
+  for (int s : {i, j, r}) {
+    if (s < 3)
+      distance[s] = 0; // seed triangle
+  }
+  if (distance[r] < 0) {
+    distance[r] = 1 + std::min(distance[i], distance[j]);
+    maxDist = std::max(maxDist, distance[r]);
+  }
+
+  kMax = std::max(
+      {kMax, network.degree(i), network.degree(j), network.degree(r)});
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "metrics.hpp"
+#include "network_observer.hpp"
+
+#include <vector>
+
+// Keeps max distance, k_max, Z and Σ w·log w up to date while a network
+// grows, so metrics can be read at any step in O(1) (Z and the entropy cost
+// one pass over the handful of distinct link energies).
+//
+// Relies on the growth rule: in addTriangle(i, j, r), r is either a seed
+// node or a new node attached to the existing link (i,j). Such a node never
+// shortens an existing path, so d(r) = 1 + min(d(i), d(j)) and all other
+// distances stay the same.
+class MetricsTracker : public NetworkObserver {
+public:
+  explicit MetricsTracker(Network &network); // attaches to network
+  ~MetricsTracker() override;                // detaches from network
+
+  MetricsTracker(const MetricsTracker &) = delete;
+  MetricsTracker &operator=(const MetricsTracker &) = delete;
+
+  int maxDistanceFromInitialTriangle() const { return maxDist; }
+  int maxDegree() const { return kMax; }
+  double partitionFunction() const { return sums.partitionFunction(); }
+  double entropyRate() const { return sums.entropyRate(); }
+
+  // Recomputes everything from the current state of the network
+  void rebuild();
+
+  void onLinkUpdated(const Network &network, const Link &link,
+                     int oldNumTriangles) override;
+  void onTriangleAdded(const Network &net, int i, int j, int r) override;
+
+private:
+  Network &net;
+  std::vector<int> distance; // hop distance from the seed triangle, -1 = unset
+  int maxDist = 0;
+  int kMax = 0;
+  EnergyLevelSums sums; // Z and Σ w log w over unsaturated links
+};
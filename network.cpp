@@ -1,9 +1,8 @@
 #include "network.hpp"
-#include <cstdlib> // for rand()
-#include <fstream> // for ofstream
-#include <limits>  // for numeric_limits
-#include <queue>   // for queue
-#include <set>     // for set
+#include "csv_writer.hpp"
+#include "profiler.hpp"
+#include <algorithm> // for min, max, remove
+#include <cmath>     // for exp
 
 Network::Network(int seed, int maxTriangles, double betaVal,
                  std::function<double(int, int)> linkEnergyFunc)
@@ -20,17 +19,38 @@ Network::Network(int seed, int maxTriangles, double betaVal,
   }
 }
 
+void Network::setStorage(NetworkStorage storage) {
+  storageMode = storage;
+  if (storage == NetworkStorage::Lean) {
+    // Same value as growthWeight(link, statistics) for this network's m
+    sampler.setLeafWeights([this](int k) {
+      const Link &link = links[k];
+      return attachmentWeight(RuntimeStatistics{m}, boltzmannFactors, beta,
+                              link.energy, link.numTriangles);
+    });
+  } else {
+    sampler.setLeafWeights(nullptr);
+  }
+}
+
 void Network::initialize() {
-  // Add 3 nodes and connect them in a triangle
-  int id1 = addNode(rand() % 10);
-  int id2 = addNode(rand() % 10);
-  int id3 = addNode(rand() % 10);
+  // Add 3 nodes and connect them in a triangle. Energies come from this
+  // network's rng (not the global rand()), so runs are reproducible per seed
+  // and safe to grow on several threads at once.
+  std::uniform_int_distribution<int> seedEnergy(0, 9);
+  int id1 = addNode(seedEnergy(rng));
+  int id2 = addNode(seedEnergy(rng));
+  int id3 = addNode(seedEnergy(rng));
   addTriangle(id1, id2, id3);
 }
 
 int Network::addNode(int energy) {
-  int id = nodes.size();
-  nodes.emplace_back(id, energy); // Create a new node with the given energy
+  int id = static_cast<int>(nodeEnergies.size());
+  nodeEnergies.push_back(energy); // Create a new node with the given energy
+  nodeDegrees.push_back(0);       // no neighbors until a triangle attaches
+  nodeTriangles.push_back(0);
+  if (storageMode == NetworkStorage::Full)
+    adjacency.addNode();
   return id;
 }
 
@@ -38,75 +58,294 @@ double Network::computeLinkEnergy(int omega_i, int omega_j) {
   return linkEnergyFunction(omega_i, omega_j);
 }
 
+double Network::linkWeight(const Link &link) const {
+  if (link.isSaturated(m))
+    return 0.0;
+  return std::exp(-beta * link.energy) * (1 + link.numTriangles);
+}
+
+void Network::reserve(int numTriangles) {
+  // Every triangle after the first adds one node and two links
+  std::size_t extra = numTriangles > 0 ? numTriangles - 1 : 0;
+  nodeEnergies.reserve(3 + extra);
+  nodeDegrees.reserve(3 + extra);
+  nodeTriangles.reserve(3 + extra);
+  links.reserve(3 + 2 * extra);
+  sampler.reserve(3 + 2 * extra);
+  if (storageMode == NetworkStorage::Lean)
+    return;
+
+  triangles.reserve(1 + extra);
+  adjacency.reserve(3 + extra, 2 * (3 + 2 * extra));
+  std::size_t capacity = linkSlots.empty() ? 16 : linkSlots.size();
+  while (capacity < 2 * links.capacity())
+    capacity *= 2;
+  if (capacity != linkSlots.size())
+    rebuildLinkSlots(capacity);
+}
+
+std::size_t Network::memoryBytes() const {
+  return (nodeEnergies.capacity() + nodeDegrees.capacity() +
+          nodeTriangles.capacity() + linkSlots.capacity() +
+          neighborOffsets.capacity() + neighborTargets.capacity()) *
+             sizeof(int) +
+         links.capacity() * sizeof(Link) +
+         triangles.capacity() * sizeof(Triangle) + adjacency.bytes() +
+         sampler.bytes();
+}
+
 void Network::addAdjacency(int u, int v) {
-  adjacencyList[u].insert(v);
-  adjacencyList[v].insert(u);
+  if (storageMode == NetworkStorage::Full) {
+    adjacency.append(u, nodeDegrees[u], v);
+    adjacency.append(v, nodeDegrees[v], u);
+  } else {
+    neighborsBuilt = false;
+  }
+  nodeDegrees[u]++;
+  nodeDegrees[v]++;
+}
+
+NeighborList Network::neighbors(int node) const {
+  if (storageMode == NetworkStorage::Full) {
+    const int *first = adjacency.list(node);
+    return {first, first + nodeDegrees[node]};
+  }
+  if (!neighborsBuilt)
+    buildNeighbors();
+  const int *targets = neighborTargets.data();
+  return {targets + neighborOffsets[node], targets + neighborOffsets[node + 1]};
+}
+
+void Network::buildNeighbors() const {
+  // Counting sort of the link ends: each list in link creation order, as
+  // the Full adjacency lists are
+  int n = numNodes();
+  neighborOffsets.assign(n + 1, 0);
+  for (int i = 0; i < n; ++i)
+    neighborOffsets[i + 1] = neighborOffsets[i] + nodeDegrees[i];
+  neighborTargets.resize(neighborOffsets[n]);
+
+  std::vector<int> fill(neighborOffsets.begin(), neighborOffsets.end() - 1);
+  for (const Link &link : links) {
+    neighborTargets[fill[link.node1]++] = link.node2;
+    neighborTargets[fill[link.node2]++] = link.node1;
+  }
+  neighborsBuilt = true;
+}
+
+namespace {
+// Mixes the sorted pair (i,j) into a 64-bit hash (splitmix64 finalizer)
+std::uint64_t hashLinkKey(int u, int v) {
+  std::uint64_t a = static_cast<std::uint32_t>(std::min(u, v));
+  std::uint64_t b = static_cast<std::uint32_t>(std::max(u, v));
+  std::uint64_t x = (a << 32) | b;
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+} // namespace
+
+int Network::findLink(int u, int v) const {
+  auto key = std::make_pair(std::min(u, v), std::max(u, v));
+  if (storageMode == NetworkStorage::Lean) {
+    for (int k = 0; k < (int)links.size(); ++k)
+      if (links[k].getSortedNodes() == key)
+        return k;
+    return -1;
+  }
+  if (linkSlots.empty())
+    return -1;
+
+  std::size_t mask = linkSlots.size() - 1;
+  for (std::size_t slot = hashLinkKey(u, v) & mask;; slot = (slot + 1) & mask) {
+    int k = linkSlots[slot];
+    if (k < 0)
+      return -1;
+    if (links[k].getSortedNodes() == key)
+      return k;
+  }
+}
+
+int Network::lookupLink(int u, int v) const {
+  if (nodeDegrees[u] == 0 || nodeDegrees[v] == 0)
+    return -1; // a new node has no links yet
+  return findLink(u, v);
+}
+
+void Network::growLinkSlots() {
+  rebuildLinkSlots(linkSlots.empty() ? 16 : 2 * linkSlots.size());
+}
+
+void Network::rebuildLinkSlots(std::size_t capacity) {
+  linkSlots.assign(capacity, -1);
+
+  std::size_t mask = capacity - 1;
+  for (int k = 0; k < (int)links.size(); ++k) {
+    std::size_t slot = hashLinkKey(links[k].node1, links[k].node2) & mask;
+    while (linkSlots[slot] >= 0)
+      slot = (slot + 1) & mask;
+    linkSlots[slot] = k;
+  }
+}
+
+double RuntimeEnergy::operator()(int omega_i, int omega_j) const {
+  return net->computeLinkEnergy(omega_i, omega_j);
+}
+
+template <class Statistics>
+double Network::growthWeight(const Link &link, const Statistics &statistics) {
+  // Same value as linkWeight(link), with e^{-βε} looked up
+  return attachmentWeight(statistics, boltzmannFactors, beta, link.energy,
+                          link.numTriangles);
+}
+
+template <class Statistics, class Energy>
+int Network::createLink(int u, int v, const Statistics &statistics,
+                        const Energy &energy) {
+  int ε = static_cast<int>(energy(nodeEnergies[u], nodeEnergies[v]));
+  int k = static_cast<int>(links.size());
+  links.emplace_back(u, v, ε);
+  sampler.add(growthWeight(links.back(), statistics)); // index == link index
+  for (NetworkObserver *observer : observers)
+    observer->onLinkUpdated(*this, links.back(), 0);
+
+  // Keep the load factor of the open-addressing table at most 1/2
+  if (storageMode == NetworkStorage::Lean) {
+    // no hash: growth never looks links up
+  } else if (2 * links.size() > linkSlots.size()) {
+    growLinkSlots(); // reinserts every link, including k
+  } else {
+    std::size_t mask = linkSlots.size() - 1;
+    std::size_t slot = hashLinkKey(u, v) & mask;
+    while (linkSlots[slot] >= 0)
+      slot = (slot + 1) & mask;
+    linkSlots[slot] = k;
+  }
+
+  addAdjacency(u, v);
+  return k;
 }
 
 void Network::addTriangle(int i, int j, int r) {
-  triangles.emplace_back(i, j, r);
-
-  auto updateOrAddLink = [&](int u, int v) {
-    auto key = std::make_pair(std::min(u, v), std::max(u, v));
-    ;
-    auto it = links.find(key);
-    if (it == links.end()) {
-      int ε = computeLinkEnergy(nodes[u].energy, nodes[v].energy);
-      links[key] = Link(u, v, ε);
+  addTriangle(i, j, r, RuntimeStatistics{m}, RuntimeEnergy{this});
+}
+
+template <class Statistics, class Energy>
+void Network::addTriangle(int i, int j, int r, const Statistics &statistics,
+                          const Energy &energy) {
+  attach(lookupLink(i, j), i, j, r, statistics, energy);
+}
+
+template <class Statistics, class Energy>
+void Network::attachTriangle(int link, int r, const Statistics &statistics,
+                             const Energy &energy) {
+  attach(link, links[link].node1, links[link].node2, r, statistics, energy);
+}
+
+template <class Statistics, class Energy>
+void Network::attach(int ij, int i, int j, int r,
+                     const Statistics &statistics, const Energy &energy) {
+  ProfileScope scope(ProfilePhase::AddTriangle);
+  bool newNode = nodeDegrees[r] == 0; // then (i,r) and (j,r) are new links
+
+  if (storageMode == NetworkStorage::Full)
+    triangles.emplace_back(i, j, r);
+  triangleTotal++;
+  nodeTriangles[i]++;
+  nodeTriangles[j]++;
+  nodeTriangles[r]++;
+
+  auto updateOrAddLink = [&](int k, int u, int v) {
+    if (k < 0) {
+      createLink(u, v, statistics, energy);
     } else {
-      it->second.numTriangles++;
+      Link &link = links[k];
+      link.numTriangles++;
+      sampler.update(k, growthWeight(link, statistics)); // 0 once saturated
+      for (NetworkObserver *observer : observers)
+        observer->onLinkUpdated(*this, link, link.numTriangles - 1);
     }
   };
 
-  updateOrAddLink(i, j);
-  updateOrAddLink(i, r);
-  updateOrAddLink(j, r);
+  updateOrAddLink(ij, i, j);
+  updateOrAddLink(newNode ? -1 : lookupLink(i, r), i, r);
+  updateOrAddLink(newNode ? -1 : lookupLink(j, r), j, r);
 
-  addAdjacency(i, j);
-  addAdjacency(j, r);
-  addAdjacency(r, i);
+  for (NetworkObserver *observer : observers)
+    observer->onTriangleAdded(*this, i, j, r);
+}
+
+// Instantiations used by the growth kernels (growth_engine.cpp)
+template void Network::addTriangle(int, int, int, const RuntimeStatistics &,
+                                   const RuntimeEnergy &);
+template void Network::addTriangle(int, int, int, const FermiDirac<2> &,
+                                   const LinearEnergy &);
+template void Network::addTriangle(int, int, int, const FermiDirac<2> &,
+                                   const QuadraticEnergy &);
+template void Network::addTriangle(int, int, int, const BoseEinstein &,
+                                   const LinearEnergy &);
+template void Network::addTriangle(int, int, int, const BoseEinstein &,
+                                   const QuadraticEnergy &);
+template void Network::attachTriangle(int, int, const RuntimeStatistics &,
+                                      const RuntimeEnergy &);
+template void Network::attachTriangle(int, int, const FermiDirac<2> &,
+                                      const LinearEnergy &);
+template void Network::attachTriangle(int, int, const FermiDirac<2> &,
+                                      const QuadraticEnergy &);
+template void Network::attachTriangle(int, int, const BoseEinstein &,
+                                      const LinearEnergy &);
+template void Network::attachTriangle(int, int, const BoseEinstein &,
+                                      const QuadraticEnergy &);
+
+void Network::addObserver(NetworkObserver *observer) {
+  observers.push_back(observer);
+}
+
+void Network::removeObserver(NetworkObserver *observer) {
+  observers.erase(std::remove(observers.begin(), observers.end(), observer),
+                  observers.end());
 }
 
 void Network::exportCSV(const std::string &filename) const {
-  std::ofstream file(filename);
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter file(filename);
   file << "Source,Target,Energy,NumTriangles\n";
 
-  for (const auto &[key, link] : links) {
-    file << link.node1 << "," << link.node2 << "," << link.energy << ","
-         << link.numTriangles << "\n";
+  for (const Link &link : links) {
+    file << link.node1 << ',' << link.node2 << ',' << link.energy << ','
+         << link.numTriangles << '\n';
   }
 
   file.close();
 }
 
 void Network::exportEdgeList(const std::string &filename) const {
-  std::ofstream out(filename);
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(filename);
   out << "Source,Target\n";
 
-  for (const auto &[key, link] : links) {
-    out << link.node1 << "," << link.node2 << "\n";
+  for (const Link &link : links) {
+    out << link.node1 << ',' << link.node2 << '\n';
   }
 
   out.close();
 }
 
 void Network::exportNodeCurvatures(const std::string &filename) const {
-  std::ofstream out(filename);
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(filename);
   out << "Node,Curvature\n";
 
-  for (const Node &node : nodes) {
-    int i = node.id;
-    int k = adjacencyList.at(i).size(); // degree
-    int T = 0;                          // triangle count
-
-    for (const auto &t : triangles) {
-      if (t.node1 == i || t.node2 == i || t.node3 == i)
-        T++;
-    }
+  for (int i = 0; i < numNodes(); ++i) {
+    int k = degree(i);        // degree
+    int T = nodeTriangles[i]; // triangle count, kept by addTriangle
 
     double R = 1.0 - (k / 2.0) + (T / 3.0);
-    out << i << "," << R << "\n";
+    out << i << ',' << R << '\n';
   }
 
   out.close();
-}
\ No newline at end of file
+}
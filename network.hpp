@@ -1,41 +1,151 @@
 #pragma once
 
+#include "adjacency_arena.hpp"
+#include "growth_policies.hpp"
 #include "link.hpp"
-#include "node.hpp"
+#include "link_sampler.hpp"
+#include "network_observer.hpp"
 #include "triangle.hpp"
 
+#include <cstdint>
 #include <functional>
-#include <map>
 #include <random>
-#include <set>
+#include <string>
 #include <utility> // for std::pair
 #include <vector>
 
+// Run state stored next to the network in a snapshot
+struct SnapshotInfo {
+  std::uint64_t step = 0;  // growth steps done when the snapshot was taken
+  std::string engineState; // GrowthEngine::saveState()
+};
+
+// What a Network keeps besides links and per-node counters (setStorage)
+enum class NetworkStorage {
+  Full, // triangle list, neighbor lists and link hash, all kept while growing
+  Lean  // none of them (52-57 B per triangle): neighbors are built from
+        // the links on the first neighbors() call, findLink scans the links
+};
+
+// Neighbors of one node, a view into the network's storage
+struct NeighborList {
+  const int *first = nullptr;
+  const int *last = nullptr;
+
+  const int *begin() const { return first; }
+  const int *end() const { return last; }
+  int size() const { return static_cast<int>(last - first); }
+};
+
 class Network {
 private:
   std::function<double(int, int)> linkEnergyFunction;
+  NetworkStorage storageMode = NetworkStorage::Full;
+
+  // Flat storage: node ids are dense, so nodes, links and neighbors live in
+  // vectors (one per field)
+  std::vector<int> nodeEnergies;  // ω_i
+  std::vector<int> nodeDegrees;   // links incident to node i
+  std::vector<int> nodeTriangles; // triangles incident to node i
+  std::vector<Link> links;        // links[k] = k-th created link
+  std::vector<int> linkSlots;     // open addressing: (i,j) -> k (Full)
+  AdjacencyArena adjacency;       // neighbors of node i (Full)
+  int triangleTotal = 0;
+
+  // Lean: neighbors of all nodes in CSR form, built on demand from the links
+  mutable std::vector<int> neighborOffsets;
+  mutable std::vector<int> neighborTargets;
+  mutable bool neighborsBuilt = false;
+  void buildNeighbors() const;
+
+  std::vector<NetworkObserver *> observers; // notified by addTriangle
+
+  BoltzmannFactors boltzmannFactors; // cached e^{-βε}
+
+  template <class Statistics>
+  double growthWeight(const Link &link, const Statistics &statistics);
+  template <class Statistics, class Energy>
+  int createLink(int u, int v, const Statistics &statistics,
+                 const Energy &energy); // appends a link and indexes it
+  void growLinkSlots();         // doubles the hash table and reinserts
+  void rebuildLinkSlots(std::size_t capacity); // reinserts every link
+  void addAdjacency(int u, int v); // adds edge (u, v), once per new link
+  int lookupLink(int u, int v) const; // findLink, -1 at once for new nodes
+
+  // ij = index of link (i,j), or -1 if (i,j) is not a link yet
+  template <class Statistics, class Energy>
+  void attach(int ij, int i, int j, int r, const Statistics &statistics,
+              const Energy &energy);
 
 public:
-  std::vector<Node> nodes; // nodes[i] = (ω_i, i)
-  std::map<std::pair<int, int>, Link>
-      links; // (i,j) -> Link, it acts as sparse adjacency matrix
-  std::vector<Triangle> triangles;            // triangles[i] = (i,j,r)
-  std::map<int, std::set<int>> adjacencyList; // adjacency list
+  std::vector<Triangle> triangles; // triangles[i] = (i,j,r); empty if Lean
 
   int m = 2;         // max triangles per link
   double beta = 0.0; // inverse temperature
   std::mt19937 rng;  // random number generator
 
+  // Growth weights of all links (index = link index), kept up to date by
+  // addTriangle
+  LinkSampler sampler;
+
   Network(int seed = 42, int maxTriangles = 2, double betaVal = 0.0,
           std::function<double(int, int)> linkEnergyFunc = nullptr);
   // Constructor: Initializes the network with a given seed for random number;
 
+  // The sampler reads link weights through this network
+  Network(const Network &) = delete;
+  Network &operator=(const Network &) = delete;
+
+  // Chooses the storage before the network is initialized or loaded; growth
+  // and metrics give identical results in both modes
+  void setStorage(NetworkStorage storage);
+  NetworkStorage storage() const { return storageMode; }
+
   void initialize();                        // t=1: initial triangle
   int addNode(int energy);                  // adds node with energy ω
   void addTriangle(int i, int j, int r);    // attach triangle to (i,j)
+
+  // Same, with m and the energy function fixed at compile time (policies in
+  // growth_policies.hpp; instantiated in network.cpp). They must describe
+  // this network: the result is then identical to addTriangle(i, j, r).
+  template <class Statistics, class Energy>
+  void addTriangle(int i, int j, int r, const Statistics &statistics,
+                   const Energy &energy);
+  // Same as addTriangle(i, j, r) for link = (i,j), without looking it up
+  template <class Statistics, class Energy>
+  void attachTriangle(int link, int r, const Statistics &statistics,
+                      const Energy &energy);
   double computeLinkEnergy(int ωi, int ωj); // ε_ij = ω_i + ω_j
+  double linkWeight(const Link &link) const; // e^{-βε}(1+n), 0 if saturated
+
+  // Preallocates storage for growth up to numTriangles triangles, so the
+  // steps in between do not reallocate or rehash
+  void reserve(int numTriangles);
+  // Triangles the network can hold without reallocating its node storage
+  int reservedTriangles() const {
+    return static_cast<int>(nodeEnergies.capacity()) - 2;
+  }
+  std::size_t memoryBytes() const; // heap held by the network's containers
 
-  void addAdjacency(int u, int v); // adds edge (u, v) to adjacency list
+  void addObserver(NetworkObserver *observer);    // not owned
+  void removeObserver(NetworkObserver *observer); // no-op if not attached
+
+  // Iteration API (callers must not rely on the underlying containers)
+  int numNodes() const { return static_cast<int>(nodeEnergies.size()); }
+  int nodeEnergy(int node) const { return nodeEnergies[node]; }
+  int numTriangles() const { return triangleTotal; }
+  const std::vector<Link> &getLinks() const { return links; }
+  const Link &getLink(int index) const { return links[index]; }
+  int numLinks() const { return static_cast<int>(links.size()); }
+  int findLink(int u, int v) const; // link index of (u,v), -1 if absent
+  int linkIndex(const Link &link) const { // link must be one of getLinks()
+    return static_cast<int>(&link - links.data());
+  }
+  // In link creation order. Lean: the first call after growth builds the
+  // lists, so make it before sharing the network between threads.
+  NeighborList neighbors(int node) const;
+  int degree(int node) const { return nodeDegrees[node]; }
+  int triangleCount(int node) const { return nodeTriangles[node]; }
 
   void exportCSV(const std::string &filename) const;
 
@@ -43,4 +153,15 @@ public:
 
   void exportNodeCurvatures(
       const std::string &filename) const; // export curvatures of nodes
+
+  // Versioned binary snapshot: node energies, links, triangles, β, m and the
+  // full rng state (network_snapshot.cpp). Loading memory-maps the file and
+  // rebuilds the index, adjacency and sampler exactly as growth left them, so
+  // a resumed run continues bit-identically. The link energy function is not
+  // stored: construct the network with the same one before loading. A Lean
+  // network writes no triangles (the counts follow from the links) and its
+  // snapshots load only into Lean networks.
+  void saveSnapshot(const std::string &filename,
+                    const SnapshotInfo &info = SnapshotInfo()) const;
+  SnapshotInfo loadSnapshot(const std::string &filename);
 };
@@ -0,0 +1,19 @@
+#pragma once
+
+class Link;
+class Network;
+
+// Receives growth events from a Network so derived quantities can be kept
+// up to date incrementally instead of being recomputed from scratch.
+class NetworkObserver {
+public:
+  virtual ~NetworkObserver() = default;
+
+  // link.numTriangles changed from oldNumTriangles (0 for a new link)
+  virtual void onLinkUpdated(const Network & /*net*/, const Link & /*link*/,
+                             int /*oldNumTriangles*/) {}
+
+  // Triangle (i,j,r) was attached; links and adjacency are already updated
+  virtual void onTriangleAdded(const Network & /*net*/, int /*i*/, int /*j*/,
+                               int /*r*/) {}
+};
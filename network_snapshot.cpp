@@ -0,0 +1,299 @@
+#include "network.hpp"
+#include "profiler.hpp"
+
+#include <cstdio>  // for fopen, fwrite, rename
+#include <cstring> // for memcpy
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File layout (native endianness, checked on load):
+//   FileHeader
+//   int32  energy[nodeCount]
+//   int32  link[linkCount][4]        node1, node2, energy, numTriangles
+//   int32  triangle[triangleCount][3]  none from a Lean network
+//   char   rngState[rngStateBytes]    std::mt19937 operator<< text
+//   char   engineState[engineStateBytes]
+
+namespace {
+constexpr char kMagic[8] = {'Q', 'N', 'E', 'T', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kEndianTag = 0x01020304;
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endianTag;
+  std::uint64_t step;
+  double beta;
+  std::int32_t m;
+  std::int32_t reserved;
+  std::uint64_t nodeCount;
+  std::uint64_t linkCount;
+  std::uint64_t triangleCount;
+  std::uint64_t rngStateBytes;
+  std::uint64_t engineStateBytes;
+};
+static_assert(sizeof(FileHeader) == 80, "snapshot header must stay packed");
+
+// Read-only view of a whole file (memory-mapped where available)
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &filename) {
+#if defined(_WIN32)
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+      throw std::runtime_error("Cannot open snapshot " + filename);
+    buffer.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+    bytes = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open snapshot " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot stat snapshot " + filename);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    if (size > 0) {
+      void *addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map snapshot " + filename);
+      }
+      ::madvise(addr, size, MADV_SEQUENTIAL);
+      bytes = static_cast<const char *>(addr);
+    }
+    ::close(fd); // the mapping stays valid
+#endif
+  }
+
+  ~MappedFile() {
+#if !defined(_WIN32)
+    if (bytes)
+      ::munmap(const_cast<char *>(bytes), size);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *bytes = nullptr;
+  std::size_t size = 0;
+
+private:
+#if defined(_WIN32)
+  std::vector<char> buffer;
+#endif
+};
+
+void writeBytes(std::FILE *file, const void *data, std::size_t size,
+                const std::string &filename) {
+  if (size > 0 && std::fwrite(data, 1, size, file) != size)
+    throw std::runtime_error("Cannot write snapshot " + filename);
+}
+} // namespace
+
+void Network::saveSnapshot(const std::string &filename,
+                           const SnapshotInfo &info) const {
+  ProfileScope scope(ProfilePhase::Snapshot);
+  std::ostringstream rngText;
+  rngText << rng;
+  std::string rngState = rngText.str();
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endianTag = kEndianTag;
+  header.step = info.step;
+  header.beta = beta;
+  header.m = m;
+  header.nodeCount = nodeEnergies.size();
+  header.linkCount = links.size();
+  header.triangleCount = triangles.size(); // 0 if Lean
+  header.rngStateBytes = rngState.size();
+  header.engineStateBytes = info.engineState.size();
+
+  const std::vector<int> &energies = nodeEnergies;
+
+  std::vector<std::int32_t> linkRecords;
+  linkRecords.reserve(4 * links.size());
+  for (const Link &link : links) {
+    linkRecords.push_back(link.node1);
+    linkRecords.push_back(link.node2);
+    linkRecords.push_back(link.energy);
+    linkRecords.push_back(link.numTriangles);
+  }
+
+  std::vector<std::int32_t> triangleRecords;
+  triangleRecords.reserve(3 * triangles.size());
+  for (const Triangle &t : triangles) {
+    triangleRecords.push_back(t.node1);
+    triangleRecords.push_back(t.node2);
+    triangleRecords.push_back(t.node3);
+  }
+
+  // Write to a temporary file and rename, so a crash never leaves a torn
+  // snapshot in place of the previous good one
+  std::string tmpName = filename + ".tmp";
+  std::FILE *file = std::fopen(tmpName.c_str(), "wb");
+  if (!file)
+    throw std::runtime_error("Cannot create snapshot " + tmpName);
+
+  try {
+    writeBytes(file, &header, sizeof(header), tmpName);
+    writeBytes(file, energies.data(), energies.size() * 4, tmpName);
+    writeBytes(file, linkRecords.data(), linkRecords.size() * 4, tmpName);
+    writeBytes(file, triangleRecords.data(), triangleRecords.size() * 4,
+               tmpName);
+    writeBytes(file, rngState.data(), rngState.size(), tmpName);
+    writeBytes(file, info.engineState.data(), info.engineState.size(),
+               tmpName);
+  } catch (...) {
+    std::fclose(file);
+    std::remove(tmpName.c_str());
+    throw;
+  }
+
+  if (std::fclose(file) != 0 || std::rename(tmpName.c_str(), filename.c_str()))
+    throw std::runtime_error("Cannot finish snapshot " + filename);
+}
+
+SnapshotInfo Network::loadSnapshot(const std::string &filename) {
+  ProfileScope scope(ProfilePhase::Snapshot);
+  MappedFile file(filename);
+
+  FileHeader header;
+  if (file.size < sizeof(header))
+    throw std::runtime_error("Truncated snapshot " + filename);
+  std::memcpy(&header, file.bytes, sizeof(header));
+
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("Not a network snapshot: " + filename);
+  if (header.version != kVersion)
+    throw std::runtime_error("Unsupported snapshot version in " + filename);
+  if (header.endianTag != kEndianTag)
+    throw std::runtime_error("Snapshot written on a different byte order: " +
+                             filename);
+
+  std::uint64_t expected = sizeof(header) + 4 * header.nodeCount +
+                           16 * header.linkCount + 12 * header.triangleCount +
+                           header.rngStateBytes + header.engineStateBytes;
+  if (file.size != expected)
+    throw std::runtime_error("Corrupt snapshot (size mismatch): " + filename);
+
+  const char *cursor = file.bytes + sizeof(header);
+  auto readInt = [&cursor]() {
+    std::int32_t value;
+    std::memcpy(&value, cursor, sizeof(value)); // mapped data is unaligned
+    cursor += sizeof(value);
+    return value;
+  };
+
+  if (header.triangleCount == 0 && header.linkCount > 0 &&
+      storageMode == NetworkStorage::Full)
+    throw std::runtime_error("Snapshot of a lean network has no triangles, "
+                             "load it with lean storage: " +
+                             filename);
+
+  beta = header.beta;
+  m = header.m;
+
+  nodeEnergies.clear();
+  nodeDegrees.clear();
+  nodeTriangles.clear();
+  links.clear();
+  linkSlots.clear();
+  triangles.clear();
+  adjacency.clear();
+  sampler.clear();
+  triangleTotal = 0;
+  neighborsBuilt = false;
+
+  int n = static_cast<int>(header.nodeCount);
+  nodeEnergies.reserve(n);
+  nodeDegrees.reserve(n);
+  nodeTriangles.reserve(n);
+  if (storageMode == NetworkStorage::Full)
+    adjacency.reserve(n, 2 * header.linkCount);
+  for (int k = 0; k < n; ++k)
+    addNode(readInt());
+
+  // Re-create links in their original order: adjacency lists and sampler
+  // leaves come out exactly as incremental growth built them
+  std::vector<double> weights;
+  links.reserve(header.linkCount);
+  weights.reserve(header.linkCount);
+  for (std::uint64_t k = 0; k < header.linkCount; ++k) {
+    int n1 = readInt();
+    int n2 = readInt();
+    int energy = readInt();
+    int numTriangles = readInt();
+    if (n1 < 0 || n2 < 0 || n1 >= n || n2 >= n)
+      throw std::runtime_error("Corrupt snapshot (bad link): " + filename);
+
+    links.emplace_back(n1, n2, energy);
+    links.back().numTriangles = numTriangles;
+    weights.push_back(linkWeight(links.back()));
+    addAdjacency(n1, n2);
+  }
+  sampler.assign(weights);
+
+  if (storageMode == NetworkStorage::Full) {
+    std::size_t capacity = 16;
+    while (capacity < 2 * links.size())
+      capacity *= 2;
+    rebuildLinkSlots(capacity);
+    triangles.reserve(header.triangleCount);
+  }
+
+  for (std::uint64_t k = 0; k < header.triangleCount; ++k) {
+    int a = readInt();
+    int b = readInt();
+    int c = readInt();
+    if (a < 0 || b < 0 || c < 0 || a >= n || b >= n || c >= n)
+      throw std::runtime_error("Corrupt snapshot (bad triangle): " + filename);
+    if (storageMode == NetworkStorage::Full)
+      triangles.emplace_back(a, b, c);
+    triangleTotal++;
+    nodeTriangles[a]++;
+    nodeTriangles[b]++;
+    nodeTriangles[c]++;
+  }
+
+  if (header.triangleCount == 0 && !links.empty()) {
+    // Every triangle is on three links and at each of its nodes on two
+    long long linkTriangles = 0;
+    for (const Link &link : links) {
+      nodeTriangles[link.node1] += link.numTriangles;
+      nodeTriangles[link.node2] += link.numTriangles;
+      linkTriangles += link.numTriangles;
+    }
+    for (int &count : nodeTriangles)
+      count /= 2;
+    triangleTotal = static_cast<int>(linkTriangles / 3);
+  }
+
+  std::istringstream rngText(std::string(cursor, header.rngStateBytes));
+  rngText >> rng;
+  if (!rngText)
+    throw std::runtime_error("Corrupt snapshot (rng state): " + filename);
+  cursor += header.rngStateBytes;
+
+  SnapshotInfo info;
+  info.step = header.step;
+  info.engineState.assign(cursor, header.engineStateBytes);
+  return info;
+}
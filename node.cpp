@@ -1,3 +0,0 @@
-#include "node.hpp"
-
-Node::Node(int id_, int energy_) : id(id_), energy(energy_) {} // Constructor
\ No newline at end of file
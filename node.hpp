@@ -1,9 +0,0 @@
-#pragma once
-
-class Node {
-public:
-  int id;     // Node id
-  int energy; // Energy of the node
-
-  Node(int id_, int energy_); // Constructor
-};
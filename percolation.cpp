@@ -0,0 +1,159 @@
+#include "percolation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace {
+// Union-find over the nodes added back so far; parent -1 = not present
+class Components {
+public:
+  explicit Components(int n) : parent(n, -1), size(n, 0) {}
+
+  void clear() {
+    std::fill(parent.begin(), parent.end(), -1);
+    largest = 0;
+  }
+
+  void add(int v) {
+    parent[v] = v;
+    size[v] = 1;
+    largest = std::max(largest, 1);
+  }
+  bool present(int v) const { return parent[v] >= 0; }
+
+  void join(int u, int v) {
+    u = root(u);
+    v = root(v);
+    if (u == v)
+      return;
+    if (size[u] < size[v])
+      std::swap(u, v);
+    parent[v] = u;
+    size[u] += size[v];
+    largest = std::max(largest, size[u]);
+  }
+
+  int largestSize() const { return largest; }
+
+private:
+  std::vector<int> parent;
+  std::vector<int> size; // valid at roots
+  int largest = 0;
+
+  int root(int v) {
+    while (parent[v] != v) {
+      parent[v] = parent[parent[v]]; // path halving
+      v = parent[v];
+    }
+    return v;
+  }
+};
+
+// Removal order o: a random permutation, stably bucketed by decreasing
+// degree for RemovalOrder::Degree (a counting sort, so O(N))
+void removalOrder(const DistanceGraph &graph, RemovalOrder kind,
+                  unsigned seed, int o, std::vector<int> &nodes,
+                  std::vector<int> &buffer) {
+  int n = graph.size();
+  std::seed_seq sequence{seed, static_cast<unsigned>(o)};
+  std::mt19937 rng(sequence);
+  nodes.resize(n);
+  std::iota(nodes.begin(), nodes.end(), 0);
+  for (int k = n - 1; k > 0; --k) {
+    std::uniform_int_distribution<int> pick(0, k);
+    std::swap(nodes[k], nodes[pick(rng)]);
+  }
+  if (kind == RemovalOrder::Random)
+    return;
+
+  int maxDegree = 0;
+  for (int v = 0; v < n; ++v)
+    maxDegree = std::max(maxDegree, graph.degree(v));
+  std::vector<int> start(maxDegree + 2, 0); // by maxDegree - degree
+  for (int v : nodes)
+    start[maxDegree - graph.degree(v) + 1]++;
+  std::partial_sum(start.begin(), start.end(), start.begin());
+  buffer.resize(n);
+  for (int v : nodes)
+    buffer[start[maxDegree - graph.degree(v)]++] = v;
+  nodes.swap(buffer);
+}
+} // namespace
+
+PercolationCurve Percolation::compute(const DistanceGraph &graph,
+                                      RemovalOrder order, int orders,
+                                      int threads, unsigned seed) {
+  PercolationCurve curve;
+  int n = std::max(graph.size(), 0);
+  if (n == 0 || orders < 1)
+    return curve;
+  curve.orders = orders;
+  threads = std::max(1, std::min(threads, orders));
+
+  // largest[t][k]: Σ over thread t's orders of the largest component after
+  // k removals; collapse[o]: removals up to the largest drop of order o
+  std::vector<std::vector<long long>> largest(threads);
+  std::vector<int> collapse(orders, 0);
+  std::atomic<int> nextOrder{0};
+  auto worker = [&](int t) {
+    std::vector<long long> &sums = largest[t];
+    sums.assign(n + 1, 0);
+    Components components(n);
+    std::vector<int> nodes, buffer;
+    for (int o = nextOrder++; o < orders; o = nextOrder++) {
+      removalOrder(graph, order, seed, o, nodes, buffer);
+      components.clear();
+      // Adding back nodes[k] turns the network after k + 1 removals into
+      // the one after k
+      int biggestDrop = -1;
+      for (int k = n - 1; k >= 0; --k) {
+        int before = components.largestSize();
+        int v = nodes[k];
+        components.add(v);
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+          int u = graph.targets[e];
+          if (components.present(u))
+            components.join(u, v);
+        }
+        sums[k] += components.largestSize();
+        if (components.largestSize() - before > biggestDrop) {
+          biggestDrop = components.largestSize() - before;
+          collapse[o] = k + 1;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(worker, t);
+  worker(0);
+  for (std::thread &t : pool)
+    t.join();
+
+  // Integer sums and per-order results: the same whichever thread ran what
+  curve.giant.assign(n + 1, 0.0);
+  for (int k = 0; k <= n; ++k) {
+    long long total = 0;
+    for (const std::vector<long long> &sums : largest)
+      total += sums[k];
+    curve.giant[k] = static_cast<double>(total) / n / orders;
+  }
+
+  double mean = 0.0;
+  for (int removed : collapse)
+    mean += static_cast<double>(removed) / n;
+  mean /= orders;
+  double squares = 0.0;
+  for (int removed : collapse) {
+    double delta = static_cast<double>(removed) / n - mean;
+    squares += delta * delta;
+  }
+  curve.threshold = mean;
+  curve.thresholdStd = orders > 1 ? std::sqrt(squares / (orders - 1)) : 0.0;
+  return curve;
+}
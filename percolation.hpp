@@ -0,0 +1,38 @@
+#pragma once
+
+#include "distance.hpp"
+
+#include <limits>
+#include <vector>
+
+// Order in which nodes are removed from the network
+enum class RemovalOrder {
+  Random, // uniformly random
+  Degree  // highest initial degree first, ties in random order
+};
+
+struct PercolationCurve {
+  int orders = 0; // removal orders averaged
+  // giant[k] = mean fraction of the nodes in the largest component once k
+  // nodes are removed, k = 0..N
+  std::vector<double> giant;
+  // Mean removed fraction at which the largest component collapses: the
+  // removal with the largest drop in its size, per order
+  double threshold = std::numeric_limits<double>::quiet_NaN();
+  double thresholdStd = std::numeric_limits<double>::quiet_NaN();
+};
+
+// Node percolation by reverse-order union-find (Newman and Ziff 2000):
+// instead of removing nodes and searching the rest for components, nodes
+// are added back in reverse removal order and joined to their present
+// neighbors in a union-find with union by size and path halving, which
+// gives the largest component after every removal in O((N + E) α(N)) per
+// order. Orders run on threads; order o draws from its own rng seeded by
+// (seed, o) and the per-thread sums are integers, so the result does not
+// depend on the number of threads.
+class Percolation {
+public:
+  static PercolationCurve compute(const DistanceGraph &graph,
+                                  RemovalOrder order, int orders = 16,
+                                  int threads = 1, unsigned seed = 42);
+};
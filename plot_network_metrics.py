@@ -3,18 +3,15 @@ import os
 import pandas as pd
 import numpy as np
 import matplotlib.pyplot as plt
-import networkx as nx
 
 os.makedirs("build/metrics", exist_ok=True)
 
-def plot_degree_distribution(edge_file, label, outname):
-    with open(edge_file, "r") as f:
-        lines = f.readlines()[1:]  # Skip header
-        G = nx.parse_edgelist(lines, delimiter=",", nodetype=int)
-    degrees = [d for _, d in G.degree()]
-    values, counts = np.unique(degrees, return_counts=True)
+# Degree and curvature histograms (and C(k)) are written by quantum_net
+
+def plot_degree_distribution(hist_file, label, outname):
+    df = pd.read_csv(hist_file)  # k,count,avg_clustering
     plt.figure()
-    plt.loglog(values, counts / counts.sum(), 'o-')
+    plt.loglog(df["k"], df["count"] / df["count"].sum(), 'o-')
     plt.xlabel("Degree k")
     plt.ylabel("P(k)")
     plt.title(f"Degree Distribution - {label}")
@@ -24,17 +21,10 @@ def plot_degree_distribution(edge_file, label, outname):
     plt.close()
     print(f"✅ Saved: {outname}_degree_distribution.png")
 
-def plot_clustering_vs_degree(edge_file, label, outname):
-    with open(edge_file, "r") as f:
-        lines = f.readlines()[1:]  # Skip header
-        G = nx.parse_edgelist(lines, delimiter=",", nodetype=int)
-    clustering = nx.clustering(G)
-    degree = dict(G.degree())
-    data = [(degree[n], clustering[n]) for n in G.nodes()]
-    df = pd.DataFrame(data, columns=["k", "C(k)"])
-    avg_ck = df.groupby("k").mean().reset_index()
+def plot_clustering_vs_degree(hist_file, label, outname):
+    df = pd.read_csv(hist_file)
     plt.figure()
-    plt.plot(avg_ck["k"], avg_ck["C(k)"], 'o-')
+    plt.plot(df["k"], df["avg_clustering"], 'o-')
     plt.xlabel("Degree k")
     plt.ylabel("Clustering Coefficient C(k)")
     plt.title(f"Clustering vs Degree - {label}")
@@ -44,11 +34,10 @@ def plot_clustering_vs_degree(edge_file, label, outname):
     plt.close()
     print(f"✅ Saved: {outname}_clustering_vs_k.png")
 
-def plot_curvature_distribution(curvature_file, label, outname):
-    df = pd.read_csv(curvature_file)
-    R = df["Curvature"]
+def plot_curvature_distribution(hist_file, label, outname):
+    df = pd.read_csv(hist_file)  # curvature,count
     plt.figure()
-    plt.hist(R, bins=100, density=True)
+    plt.hist(df["curvature"], bins=100, weights=df["count"], density=True)
     plt.xlabel("Curvature R")
     plt.ylabel("P(R)")
     plt.title(f"Curvature Distribution - {label}")
@@ -58,19 +47,47 @@ def plot_curvature_distribution(curvature_file, label, outname):
     plt.close()
     print(f"✅ Saved: {outname}_curvature_distribution.png")
 
+def plot_spectral_density(density_file, label, outname):
+    df = pd.read_csv(density_file)  # lambda,density (KPM, --spectral)
+    plt.figure()
+    plt.semilogy(df["lambda"], df["density"].clip(lower=1e-6))
+    plt.xlabel("Eigenvalue λ of the normalized Laplacian")
+    plt.ylabel("ρ(λ)")
+    plt.title(f"Spectral Density - {label}")
+    plt.grid(True)
+    plt.tight_layout()
+    plt.savefig(f"build/metrics/{outname}_spectral_density.png", dpi=300)
+    plt.close()
+    print(f"✅ Saved: {outname}_spectral_density.png")
+
+def plot_heat_kernel(heat_file, nodes, label, outname):
+    df = pd.read_csv(heat_file)  # t,return_probability,uncertainty,...
+    excess = df["return_probability"] - 1.0 / nodes
+    keep = excess > 3 * df["uncertainty"]
+    plt.figure()
+    plt.loglog(df["t"][keep], excess[keep], 'o-', markersize=3)
+    plt.xlabel("t")
+    plt.ylabel("P(t) - 1/N")
+    plt.title(f"Heat Kernel Return Probability - {label}")
+    plt.grid(True)
+    plt.tight_layout()
+    plt.savefig(f"build/metrics/{outname}_heat_kernel.png", dpi=300)
+    plt.close()
+    print(f"✅ Saved: {outname}_heat_kernel.png")
+
 # --- Batch run for β = 0.05, 0.5, 5.0 ---
 cases = ["fermi", "bose"]
 betas = ["0_05", "0_50", "5_00"]
 
 def plot_adjacency_matrix(edge_file, label, outname, max_nodes=1000):
-    with open(edge_file, "r") as f:
-        lines = f.readlines()[1:]  # Skip header
-        G = nx.parse_edgelist(lines, delimiter=",", nodetype=int)
+    edges = pd.read_csv(edge_file)
 
-    # Take only a subset of the nodes
-    nodes = sorted(G.nodes())[:max_nodes]
-    G_sub = G.subgraph(nodes)
-    A = nx.to_numpy_array(G_sub, nodelist=nodes)
+    # Take only a subset of the nodes (ids are dense, oldest first)
+    sub = edges[(edges["Source"] < max_nodes) & (edges["Target"] < max_nodes)]
+    n = min(max_nodes, int(edges[["Source", "Target"]].max().max()) + 1)
+    A = np.zeros((n, n))
+    A[sub["Source"], sub["Target"]] = 1
+    A[sub["Target"], sub["Source"]] = 1
 
     plt.figure(figsize=(8, 8))
     plt.imshow(A, cmap="viridis", interpolation="nearest")
@@ -88,11 +105,23 @@ for case in cases:
         prefix = f"build/raw_csv/{case}_{tag}"
         label = f"{case.capitalize()} β={beta_str.replace('_', '.')}"
 
-        if not os.path.exists(f"{prefix}_edges.csv"):
+        edge_file = f"{prefix}_edges.csv"
+        if not os.path.exists(edge_file):
+            edge_file += ".gz"  # --compress-exports; pandas reads it as is
+        if not os.path.exists(edge_file):
             print(f"⚠️  Skipping {prefix} — edges file not found.")
             continue
 
-        plot_degree_distribution(f"{prefix}_edges.csv", label, f"{case}_{tag}")
-        plot_clustering_vs_degree(f"{prefix}_edges.csv", label, f"{case}_{tag}")
-        plot_curvature_distribution(f"{prefix}_curvature_nodes.csv", label, f"{case}_{tag}")
-        plot_adjacency_matrix(f"{prefix}_edges.csv", label, f"{case}_{tag}")
\ No newline at end of file
+        plot_degree_distribution(f"{prefix}_degree_hist.csv", label, f"{case}_{tag}")
+        plot_clustering_vs_degree(f"{prefix}_degree_hist.csv", label, f"{case}_{tag}")
+        plot_curvature_distribution(f"{prefix}_curvature_hist.csv", label, f"{case}_{tag}")
+        plot_adjacency_matrix(edge_file, label, f"{case}_{tag}")
+
+        # Written only by runs with --spectral
+        spectral = prefix
+        if not os.path.exists(f"{spectral}_spectral_density.csv"):
+            spectral = f"build/raw_csv/{case}_beta{beta_str}_N100000"  # sweep
+        if os.path.exists(f"{spectral}_spectral_density.csv"):
+            nodes = pd.read_csv(f"{prefix}_degree_hist.csv")["count"].sum()
+            plot_spectral_density(f"{spectral}_spectral_density.csv", label, f"{case}_{tag}")
+            plot_heat_kernel(f"{spectral}_heat_kernel.csv", nodes, label, f"{case}_{tag}")
\ No newline at end of file
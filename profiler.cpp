@@ -0,0 +1,101 @@
+#include "profiler.hpp"
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+constexpr int kPhases = (int)ProfilePhase::Count;
+
+struct ThreadSlots {
+  std::array<std::atomic<std::uint64_t>, kPhases> calls{};
+  std::array<std::atomic<std::uint64_t>, kPhases> nanoseconds{};
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadSlots>> registry; // outlives the threads
+
+ThreadSlots &localSlots() {
+  thread_local ThreadSlots *slots = [] {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(std::make_unique<ThreadSlots>());
+    return registry.back().get();
+  }();
+  return *slots;
+}
+} // namespace
+
+std::atomic<bool> Profiler::active{false};
+
+const char *profilePhaseName(ProfilePhase phase) {
+  switch (phase) {
+  case ProfilePhase::SampleLink:
+    return "sample_link";
+  case ProfilePhase::AddTriangle:
+    return "add_triangle";
+  case ProfilePhase::Metrics:
+    return "metrics";
+  case ProfilePhase::Export:
+    return "export";
+  case ProfilePhase::Snapshot:
+    return "snapshot";
+  default:
+    return "unknown";
+  }
+}
+
+void Profiler::setEnabled(bool on) {
+  active.store(on, std::memory_order_relaxed);
+}
+
+void Profiler::record(ProfilePhase phase, std::uint64_t nanoseconds) {
+  // Only the owning thread writes its slots; relaxed atomics keep report()
+  // race-free without any contention
+  ThreadSlots &slots = localSlots();
+  int p = (int)phase;
+  slots.calls[p].store(slots.calls[p].load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+  slots.nanoseconds[p].store(
+      slots.nanoseconds[p].load(std::memory_order_relaxed) + nanoseconds,
+      std::memory_order_relaxed);
+}
+
+std::array<PhaseStats, kPhases> Profiler::report() {
+  std::array<PhaseStats, kPhases> total{};
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (const auto &slots : registry) {
+    for (int p = 0; p < kPhases; ++p) {
+      total[p].calls += slots->calls[p].load(std::memory_order_relaxed);
+      total[p].nanoseconds +=
+          slots->nanoseconds[p].load(std::memory_order_relaxed);
+    }
+  }
+  return total;
+}
+
+void Profiler::reset() {
+  // Call while no profiled work is running
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (const auto &slots : registry) {
+    for (int p = 0; p < kPhases; ++p) {
+      slots->calls[p].store(0, std::memory_order_relaxed);
+      slots->nanoseconds[p].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+std::string Profiler::toJson() {
+  std::array<PhaseStats, kPhases> stats = report();
+
+  std::ostringstream out;
+  out << std::setprecision(9) << "{";
+  for (int p = 0; p < kPhases; ++p) {
+    out << (p > 0 ? "," : "") << "\"" << profilePhaseName((ProfilePhase)p)
+        << "\":{\"calls\":" << stats[p].calls
+        << ",\"seconds\":" << stats[p].nanoseconds * 1e-9 << "}";
+  }
+  out << "}";
+  return out.str();
+}
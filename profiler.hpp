@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Phases timed by ProfileScope
+enum class ProfilePhase {
+  SampleLink,  // GrowthEngine: choosing the link a triangle attaches to
+  AddTriangle, // Network::addTriangle, including observer updates
+  Metrics,     // Metrics:: calls and metric rows
+  Export,      // CSV exporters
+  Snapshot,    // Network::saveSnapshot / loadSnapshot
+  Count
+};
+
+const char *profilePhaseName(ProfilePhase phase); // "sample_link", ...
+
+struct PhaseStats {
+  std::uint64_t calls = 0;
+  std::uint64_t nanoseconds = 0;
+};
+
+// Process-wide per-phase call counts and times, off by default. Each thread
+// accumulates into its own slots (no contention between sweep workers);
+// report() sums them. When disabled a ProfileScope costs one relaxed load.
+class Profiler {
+public:
+  static void setEnabled(bool on);
+  static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+  static void record(ProfilePhase phase, std::uint64_t nanoseconds);
+  static std::array<PhaseStats, (int)ProfilePhase::Count> report();
+  static void reset();
+
+  // {"sample_link":{"calls":..,"seconds":..},...}
+  static std::string toJson();
+
+private:
+  static std::atomic<bool> active;
+};
+
+// Times the enclosing scope into `phase`. Nested scopes of the same phase
+// (e.g. Metrics calling Metrics) only count the outermost one.
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfilePhase p) : phase(p) {
+    if (!Profiler::enabled())
+      return;
+    counted = true;
+    if (depth()[(int)phase]++ == 0) {
+      timing = true;
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ProfileScope() {
+    if (!counted)
+      return;
+    depth()[(int)phase]--;
+    if (timing) {
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      Profiler::record(phase,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           elapsed)
+                           .count());
+    }
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  ProfilePhase phase;
+  bool counted = false; // enabled when the scope opened
+  bool timing = false;  // outermost scope of its phase
+  std::chrono::steady_clock::time_point start;
+
+  static std::array<int, (int)ProfilePhase::Count> &depth() {
+    thread_local std::array<int, (int)ProfilePhase::Count> d{};
+    return d;
+  }
+};
@@ -0,0 +1,265 @@
+// quantum_net_replay: rebuilds a run's network from its event log (written
+// with --event-log) at chosen steps and evaluates metrics there, without
+// growing it again. Replay skips the link draws and the energy sampling, so
+// any step is reached far faster than by regrowing the run.
+// Rows go to a CSV with the columns of the run's metrics file. The O(1)
+// metrics (max_distance, k_max, entropy) fill every row; the costly ones
+// only where asked for, and are left empty otherwise.
+#include "csv_writer.hpp"
+#include "event_log.hpp"
+#include "experiment.hpp"
+#include "metrics.hpp"
+#include "metrics_tracker.hpp"
+#include "network.hpp"
+#include "spectral.hpp"
+#include "sweep_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+// Costly metrics of the CSV row, as bits of ReplayOptions::metrics
+enum ReplayMetric : unsigned {
+  Clustering = 1u << 0,
+  Modularity = 1u << 1,
+  PathLength = 1u << 2, // avg_path_length and diameter
+  SpectralDimension = 1u << 3,
+  AllMetrics = (1u << 4) - 1,
+};
+
+struct ReplayOptions {
+  std::string logFile;
+  int every = 666;              // row interval, as the run's --interval
+  std::vector<long long> steps; // explicit rows instead of --every
+  unsigned metrics = 0;
+  int threads = 1; // time windows replayed in parallel
+  int louvainRestarts = 4;
+  int pathSamples = 64;
+  int spectralMoments = 400;
+  int spectralVectors = 8;
+  std::string outputFile; // default: <log>_replay.csv
+};
+
+unsigned parseMetrics(const std::string &list) {
+  unsigned metrics = 0;
+  std::stringstream stream(list);
+  std::string name;
+  while (std::getline(stream, name, ',')) {
+    if (name == "max_distance" || name == "k_max" || name == "entropy")
+      continue; // always reported
+    if (name == "avg_clustering")
+      metrics |= Clustering;
+    else if (name == "modularity")
+      metrics |= Modularity;
+    else if (name == "avg_path_length" || name == "diameter")
+      metrics |= PathLength;
+    else if (name == "spectral_dimension")
+      metrics |= SpectralDimension;
+    else if (name == "all")
+      metrics |= AllMetrics;
+    else
+      throw std::invalid_argument("unknown metric '" + name + "'");
+  }
+  return metrics;
+}
+
+std::vector<long long> parseSteps(const std::string &list) {
+  std::vector<long long> steps;
+  std::stringstream stream(list);
+  std::string value;
+  while (std::getline(stream, value, ','))
+    steps.push_back(std::stoll(value));
+  return steps;
+}
+
+// Rows are labelled like the run's metrics CSV: row s is the network after
+// s + 1 steps, so the final row is total - 1 (0 if nothing was grown)
+int stepsOfRow(long long row, int total) {
+  return static_cast<int>(std::min<long long>(row + 1, total));
+}
+
+MetricRow evaluate(const Network &net, const MetricsTracker &tracker,
+                   long long label, const ReplayOptions &options,
+                   unsigned seed, int threads) {
+  MetricRow row;
+  row.step = label;
+  row.maxDistance = tracker.maxDistanceFromInitialTriangle();
+  row.kMax = tracker.maxDegree();
+  row.entropy = tracker.entropyRate();
+  unsigned metrics = options.metrics;
+  if (metrics & Clustering)
+    row.avgClustering = Metrics::averageClustering(net);
+  if ((metrics & Modularity) && options.louvainRestarts > 0)
+    row.modularity =
+        Metrics::louvain(net, options.louvainRestarts, threads, seed)
+            .modularity;
+  if (metrics & PathLength) {
+    PathLengthStats paths =
+        Metrics::pathLengths(net, options.pathSamples, threads, seed);
+    row.avgPathLength = paths.averagePathLength;
+    row.diameter = paths.diameter;
+  }
+  if (metrics & SpectralDimension) {
+    // As the run's --spectral
+    SparseLaplacian laplacian = Metrics::laplacian(net);
+    KernelPolynomial kpm(laplacian, options.spectralMoments,
+                         options.spectralVectors, threads, seed);
+    row.spectralDimension =
+        spectralDimension(kpm.heatKernel(0.1, 100), laplacian.size(),
+                          kpm.maxTime() / 10, kpm.maxTime());
+  }
+  return row;
+}
+
+// Replays rows [first, last) of `rows` (sorted) into one network
+void replayWindow(const EventLog &log, const std::vector<long long> &rows,
+                  std::size_t first, std::size_t last,
+                  const ReplayOptions &options, int metricThreads,
+                  std::vector<MetricRow> &results) {
+  const EventLogHeader &header = log.header();
+  Network net(header.seed, header.m, header.beta, log.energyFunction());
+  // No triangle list or link hash to maintain; the metrics only need the
+  // neighbor lists, built from the links when first asked for
+  net.setStorage(NetworkStorage::Lean);
+  net.reserve(stepsOfRow(rows[last - 1], log.steps()) + 1);
+  log.start(net);
+  MetricsTracker tracker(net); // attached at t = 1 like the run's
+
+  for (std::size_t k = first; k < last; ++k) {
+    log.replay(net, stepsOfRow(rows[k], log.steps()));
+    results[k] = evaluate(net, tracker, rows[k], options,
+                          static_cast<unsigned>(header.seed), metricThreads);
+  }
+}
+
+std::string usage() {
+  return "Usage: quantum_net_replay LOG [options]\n"
+         "\n"
+         "  --every S           a row every S steps and the final row (666)\n"
+         "  --steps a,b,...     rows at these steps instead, labelled as in\n"
+         "                      the metrics CSV (row s: after s + 1 steps)\n"
+         "  --metrics LIST      also these columns, comma-separated, or all:\n"
+         "                      avg_clustering, modularity, avg_path_length,\n"
+         "                      diameter, spectral_dimension (max_distance,\n"
+         "                      k_max and entropy fill every row)\n"
+         "  --threads W         time windows replayed in parallel (1)\n"
+         "  --louvain-restarts R  as quantum_net (4)\n"
+         "  --path-samples P    as quantum_net (64)\n"
+         "  --spectral-moments M  as quantum_net (400)\n"
+         "  --spectral-vectors R  as quantum_net (8)\n"
+         "  --output FILE       CSV to write (<LOG without .qlog>_replay.csv)\n"
+         "  --help              show this message\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  ReplayOptions options;
+  try {
+    for (int a = 1; a < argc; ++a) {
+      std::string arg = argv[a];
+      bool hasValue = a + 1 < argc;
+      if (arg == "--every" && hasValue) {
+        options.every = std::stoi(argv[++a]);
+      } else if (arg == "--steps" && hasValue) {
+        options.steps = parseSteps(argv[++a]);
+      } else if (arg == "--metrics" && hasValue) {
+        options.metrics = parseMetrics(argv[++a]);
+      } else if (arg == "--threads" && hasValue) {
+        options.threads = std::stoi(argv[++a]);
+      } else if (arg == "--louvain-restarts" && hasValue) {
+        options.louvainRestarts = std::stoi(argv[++a]);
+      } else if (arg == "--path-samples" && hasValue) {
+        options.pathSamples = std::stoi(argv[++a]);
+      } else if (arg == "--spectral-moments" && hasValue) {
+        options.spectralMoments = std::stoi(argv[++a]);
+      } else if (arg == "--spectral-vectors" && hasValue) {
+        options.spectralVectors = std::stoi(argv[++a]);
+      } else if (arg == "--output" && hasValue) {
+        options.outputFile = argv[++a];
+      } else if (arg == "--help") {
+        std::cout << usage();
+        return 0;
+      } else if (options.logFile.empty() && arg.rfind("--", 0) != 0) {
+        options.logFile = arg;
+      } else {
+        std::cerr << "❌ unknown option '" << arg << "'\n\n" << usage();
+        return 1;
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "❌ " << e.what() << "\n\n" << usage();
+    return 1;
+  }
+  if (options.logFile.empty() || options.every < 1 || options.threads < 1) {
+    std::cerr << usage();
+    return 1;
+  }
+  if (options.outputFile.empty()) {
+    fs::path output(options.logFile);
+    output.replace_extension();
+    options.outputFile = output.string() + "_replay.csv";
+  }
+
+  try {
+    auto start = std::chrono::steady_clock::now();
+    EventLog log(options.logFile);
+    int total = log.steps();
+
+    std::vector<long long> rows = options.steps;
+    if (rows.empty()) {
+      for (long long s = 0; s < total; s += options.every)
+        rows.push_back(s);
+      rows.push_back(std::max(total - 1, 0));
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    int finalRow = std::max(total - 1, 0);
+    if (rows.empty() || rows.front() < 0 || rows.back() > finalRow)
+      throw std::out_of_range("steps must lie in 0.." +
+                              std::to_string(finalRow));
+
+    // Contiguous windows of rows, each replayed from the seed triangle in a
+    // network of its own; later windows replay more steps, so they go first
+    int windows = std::min<int>(options.threads, static_cast<int>(rows.size()));
+    int metricThreads = std::max(1, options.threads / windows);
+    std::vector<MetricRow> results(rows.size());
+    SweepScheduler scheduler(windows);
+    for (int w = 0; w < windows; ++w) {
+      std::size_t first = rows.size() * w / windows;
+      std::size_t last = rows.size() * (w + 1) / windows;
+      scheduler.addJob(static_cast<double>(rows[last - 1]), [&, first, last] {
+        replayWindow(log, rows, first, last, options, metricThreads, results);
+      }, "steps " + std::to_string(rows[first]) + ".." +
+                             std::to_string(rows[last - 1]));
+    }
+    std::vector<std::string> failures = scheduler.run();
+    if (!failures.empty()) {
+      for (const std::string &failure : failures)
+        std::cerr << "❌ " << failure << std::endl;
+      return 1;
+    }
+
+    CsvWriter out(options.outputFile);
+    out << metricsHeader << '\n';
+    for (const MetricRow &row : results)
+      writeMetricRow(out, row);
+    out.close();
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    std::cout << "✅ " << rows.size() << " rows of " << total << " steps in "
+              << seconds << " s: " << options.outputFile << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "❌ " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
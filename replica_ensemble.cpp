@@ -0,0 +1,453 @@
+#include "replica_ensemble.hpp"
+#include "growth_policies.hpp"
+#include "network.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QN_REPLICA_AVX2 1 // compiled for AVX2, used if the CPU has it
+#include <immintrin.h>
+#else
+#define QN_REPLICA_AVX2 0
+#endif
+
+ReplicaEnsemble::ReplicaEnsemble(const std::vector<int> &seedList, int m_,
+                                 double beta_, bool quadraticEnergy,
+                                 int lambda)
+    : count(static_cast<int>(seedList.size())), m(m_), beta(beta_),
+      quadratic(quadraticEnergy), seeds(seedList) {
+  if (count == 0)
+    throw std::invalid_argument("ReplicaEnsemble needs at least one seed");
+#if QN_REPLICA_AVX2
+  hasAvx2 = __builtin_cpu_supports("avx2");
+#else
+  hasAvx2 = false;
+#endif
+  vectorized = hasAvx2;
+
+  for (int seed : seeds) {
+    rngs.emplace_back(seed); // as Network: rng.seed(seed)
+    energyDraws.emplace_back(lambda);
+  }
+  maxDist.assign(count, 0);
+  kMax.assign(count, 0);
+  sums.assign(count, EnergyLevelSums(beta));
+  draws.assign(count, 0.0);
+  picked.assign(count, 0);
+  omegas.assign(count, 0);
+  ends.assign(2 * count, 0);
+  energies.assign(3 * count, 0);
+}
+
+int ReplicaEnsemble::linkEnergy(int omega_i, int omega_j) const {
+  if (quadratic)
+    return static_cast<int>(QuadraticEnergy()(omega_i, omega_j));
+  return static_cast<int>(LinearEnergy()(omega_i, omega_j));
+}
+
+Link ReplicaEnsemble::link(int replica, int index) const {
+  std::size_t at = static_cast<std::size_t>(index) * count + replica;
+  Link result(linkNodes1[at], linkNodes2[at], linkEnergies[at]);
+  result.numTriangles = linkTriangles[at];
+  return result;
+}
+
+void ReplicaEnsemble::reserve(int numTriangles) {
+  std::size_t extra = numTriangles > 0 ? numTriangles - 1 : 0;
+  std::size_t nodeSlots = (3 + extra) * count;
+  std::size_t linkSlots = (3 + 2 * extra) * count;
+  for (std::vector<int> *field : {&nodeEnergies, &nodeDegrees, &nodeDistances})
+    field->reserve(nodeSlots);
+  for (std::vector<int> *field :
+       {&linkNodes1, &linkNodes2, &linkEnergies, &linkTriangles})
+    field->reserve(linkSlots);
+  attached.reserve(extra * count);
+
+  int newCapacity = capacity > 0 ? capacity : 16;
+  while (newCapacity < static_cast<int>(3 + 2 * extra))
+    newCapacity *= 2;
+  if (newCapacity != capacity)
+    growTrees(newCapacity);
+}
+
+std::size_t ReplicaEnsemble::memoryBytes() const {
+  return (nodeEnergies.capacity() + nodeDegrees.capacity() +
+          nodeDistances.capacity() + linkNodes1.capacity() +
+          linkNodes2.capacity() + linkEnergies.capacity() +
+          linkTriangles.capacity() + attached.capacity()) *
+             sizeof(int) +
+         trees.capacity() * sizeof(double) +
+         rngs.capacity() * sizeof(std::mt19937);
+}
+
+void ReplicaEnsemble::growTrees(int newCapacity) {
+  // As LinkSampler::grow: the old tree is the left subtree of the new one
+  std::vector<double> old;
+  old.swap(trees);
+  int oldCapacity = capacity;
+  capacity = newCapacity;
+  trees.assign(2 * static_cast<std::size_t>(capacity) * count, 0.0);
+  if (oldCapacity > 0)
+    std::copy(old.begin() + static_cast<std::size_t>(oldCapacity) * count,
+              old.begin() +
+                  static_cast<std::size_t>(oldCapacity + links) * count,
+              trees.begin() + static_cast<std::size_t>(capacity) * count);
+  for (std::size_t node = capacity - 1; node >= 1; --node) {
+    double *sum = &trees[node * count];
+    const double *left = &trees[2 * node * count];
+    const double *right = left + count;
+    for (int r = 0; r < count; ++r)
+      sum[r] = left[r] + right[r];
+  }
+}
+
+void ReplicaEnsemble::initialize() {
+  // As Network::initialize followed by addTriangle(0, 1, 2)
+  std::uniform_int_distribution<int> seedEnergy(0, 9);
+  nodeEnergies.resize(3 * count);
+  for (int r = 0; r < count; ++r) {
+    for (int node = 0; node < 3; ++node)
+      nodeEnergies[node * count + r] = seedEnergy(rngs[r]);
+  }
+  nodes = 3;
+  nodeDegrees.assign(3 * count, 2);
+  nodeDistances.assign(3 * count, 0); // the seed triangle
+
+  const int ends[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+  links = 3;
+  linkNodes1.resize(3 * count);
+  linkNodes2.resize(3 * count);
+  linkEnergies.resize(3 * count);
+  linkTriangles.assign(3 * count, 1);
+  if (capacity == 0)
+    growTrees(16);
+  RuntimeStatistics statistics{m};
+  for (int r = 0; r < count; ++r) {
+    for (int k = 0; k < 3; ++k) {
+      std::size_t at = static_cast<std::size_t>(k) * count + r;
+      int u = ends[k][0], v = ends[k][1];
+      linkNodes1[at] = u;
+      linkNodes2[at] = v;
+      linkEnergies[at] = linkEnergy(nodeEnergies[u * count + r],
+                                    nodeEnergies[v * count + r]);
+      bool saturated = statistics.saturated(1);
+      trees[(capacity + k) * static_cast<std::size_t>(count) + r] =
+          attachmentWeight(statistics, boltzmannFactors, beta,
+                           linkEnergies[at], 1);
+      if (!saturated)
+        sums[r].add(linkEnergies[at], 2); // as MetricsTracker::rebuild
+    }
+    maxDist[r] = 0;
+    kMax[r] = 2;
+  }
+  for (std::size_t node = capacity - 1; node >= 1; --node) {
+    for (int r = 0; r < count; ++r)
+      trees[node * count + r] =
+          trees[2 * node * count + r] + trees[(2 * node + 1) * count + r];
+  }
+  steps = 0;
+}
+
+void ReplicaEnsemble::grow(int numSteps) {
+  if (m == FermiDirac<2>::maxTriangles)
+    growSteps(numSteps, FermiDirac<2>());
+  else if (m == BoseEinstein::maxTriangles)
+    growSteps(numSteps, BoseEinstein());
+  else
+    growSteps(numSteps, RuntimeStatistics{m});
+}
+
+template <class Statistics>
+void ReplicaEnsemble::growSteps(int numSteps, const Statistics &statistics) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  for (int s = 0; s < numSteps; ++s) {
+    // Draw a link in every replica, P(ij) ∝ e^{-βε_ij}(1+n_ij)
+    {
+      ProfileScope scope(ProfilePhase::SampleLink);
+      for (int r = 0; r < count; ++r) {
+        double Z = trees[count + r];
+        if (Z == 0.0) {
+          std::cout << "⚠️ No valid links available for growth (Z = 0). "
+                       "Hanging prevented.\n";
+          throw std::runtime_error("No possible growth steps (Z = 0).");
+        }
+        draws[r] = uniform(rngs[r]) * Z;
+      }
+      if (vectorized)
+        sampleLinksAvx2();
+      else
+        sampleLinks();
+    }
+
+    ProfileScope scope(ProfilePhase::AddTriangle);
+    if (links + 2 > capacity)
+      growTrees(2 * capacity);
+    int node = nodes;
+    int first = links; // links (i, node) and (j, node)
+    std::size_t nodeAt = static_cast<std::size_t>(node) * count;
+    std::size_t firstAt = static_cast<std::size_t>(first) * count;
+    std::size_t leafBase = static_cast<std::size_t>(capacity) * count;
+    for (std::vector<int> *field :
+         {&nodeEnergies, &nodeDegrees, &nodeDistances})
+      field->resize(nodeAt + count);
+    for (std::vector<int> *field :
+         {&linkNodes1, &linkNodes2, &linkEnergies, &linkTriangles})
+      field->resize(firstAt + 2 * count);
+    attached.resize(static_cast<std::size_t>(steps + 1) * count);
+
+    // One short loop per phase, each over all replicas: their random
+    // accesses are independent, so the cache misses of a phase overlap
+    for (int r = 0; r < count; ++r) {
+      omegas[r] = energyDraws[r](rngs[r]); // new node's Poisson energy
+      nodeEnergies[nodeAt + r] = omegas[r];
+      attached[static_cast<std::size_t>(steps) * count + r] = picked[r];
+    }
+
+    // Link k gains a triangle
+    for (int r = 0; r < count; ++r) {
+      std::size_t kAt = static_cast<std::size_t>(picked[r]) * count + r;
+      ends[2 * r] = linkNodes1[kAt];
+      ends[2 * r + 1] = linkNodes2[kAt];
+      int n = ++linkTriangles[kAt];
+      energies[3 * r] = linkEnergies[kAt];
+      trees[leafBase + kAt] = attachmentWeight(
+          statistics, boltzmannFactors, beta, energies[3 * r], n);
+    }
+
+    // Links (i, node) and (j, node), one triangle each
+    for (int r = 0; r < count; ++r) {
+      for (int e = 0; e < 2; ++e) {
+        int u = ends[2 * r + e];
+        std::size_t at = firstAt + static_cast<std::size_t>(e) * count + r;
+        int ε = linkEnergy(nodeEnergies[u * count + r], omegas[r]);
+        linkNodes1[at] = u;
+        linkNodes2[at] = node;
+        linkEnergies[at] = ε;
+        linkTriangles[at] = 1;
+        trees[leafBase + at] =
+            attachmentWeight(statistics, boltzmannFactors, beta, ε, 1);
+        energies[3 * r + 1 + e] = ε;
+      }
+    }
+
+    // Degrees and distances (MetricsTracker::onTriangleAdded)
+    for (int r = 0; r < count; ++r) {
+      int i = ends[2 * r], j = ends[2 * r + 1];
+      int degreeI = ++nodeDegrees[i * count + r];
+      int degreeJ = ++nodeDegrees[j * count + r];
+      nodeDegrees[nodeAt + r] = 2;
+      int d = 1 + std::min(nodeDistances[i * count + r],
+                           nodeDistances[j * count + r]);
+      nodeDistances[nodeAt + r] = d;
+      maxDist[r] = std::max(maxDist[r], d);
+      kMax[r] = std::max({kMax[r], degreeI, degreeJ, 2});
+    }
+
+    // Z and Σ w log w, in MetricsTracker's order: link k, then the new links
+    for (int r = 0; r < count; ++r) {
+      std::size_t kAt = static_cast<std::size_t>(picked[r]) * count + r;
+      int n = linkTriangles[kAt];
+      int old = n - 1;
+      if (old > 0 && old < m)
+        sums[r].remove(energies[3 * r], 1 + old);
+      if (n < m)
+        sums[r].add(energies[3 * r], 1 + n);
+      if (1 < m) {
+        sums[r].add(energies[3 * r + 1], 2);
+        sums[r].add(energies[3 * r + 2], 2);
+      }
+    }
+    nodes++;
+    links += 2;
+    steps++;
+
+    if (vectorized)
+      updatePathsAvx2();
+    else
+      updatePaths();
+  }
+}
+
+void ReplicaEnsemble::sampleLinks() {
+  // LinkSampler::sample, one level of every tree at a time; the replicas'
+  // memory accesses are independent, so their cache misses overlap
+  std::size_t stride = count;
+  for (int r = 0; r < count; ++r)
+    picked[r] = 1;
+  for (int level = capacity; level > 1; level /= 2) {
+    for (int r = 0; r < count; ++r) {
+      std::size_t left = 2 * static_cast<std::size_t>(picked[r]);
+      double leftWeight = trees[left * stride + r];
+      double rightWeight = trees[(left + 1) * stride + r];
+      // Never descend into an empty subtree, as LinkSampler::sample
+      if (draws[r] < leftWeight || rightWeight == 0.0) {
+        picked[r] = static_cast<int>(left);
+      } else {
+        draws[r] -= leftWeight;
+        picked[r] = static_cast<int>(left + 1);
+      }
+    }
+  }
+  for (int r = 0; r < count; ++r)
+    picked[r] -= capacity;
+}
+
+void ReplicaEnsemble::updatePaths() {
+  std::size_t stride = count;
+  int first = capacity + links - 2;
+  for (int shift = 1; (capacity >> shift) >= 1; ++shift) {
+    for (int r = 0; r < count; ++r) {
+      std::size_t node = (capacity + picked[r]) >> shift;
+      trees[node * stride + r] =
+          trees[2 * node * stride + r] + trees[(2 * node + 1) * stride + r];
+    }
+    for (int leaf : {first, first + 1}) {
+      std::size_t node = leaf >> shift;
+      if (leaf == first + 1 && node == static_cast<std::size_t>(first >> shift))
+        continue; // same parent as the other new link
+      double *sum = &trees[node * stride];
+      const double *left = &trees[2 * node * stride];
+      const double *right = left + stride;
+      for (int r = 0; r < count; ++r)
+        sum[r] = left[r] + right[r];
+    }
+  }
+}
+
+#if QN_REPLICA_AVX2
+// Same comparisons, subtractions and sums as the scalar loops, four
+// replicas per vector; no FMA, so every value is bit-identical
+__attribute__((target("avx2"))) void ReplicaEnsemble::sampleLinksAvx2() {
+  const double *tree = trees.data();
+  const __m256i stride = _mm256_set1_epi64x(count);
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256d zero = _mm256_setzero_pd();
+  // One level of every group of four trees at a time, like sampleLinks;
+  // u and the current node stay in draws and picked between levels
+  int groups = count / 4;
+  for (int r = 0; r < 4 * groups; ++r)
+    picked[r] = 1;
+  for (int level = capacity; level > 1; level /= 2) {
+    for (int r = 0; r < 4 * groups; r += 4) {
+      __m256i lane = _mm256_setr_epi64x(r, r + 1, r + 2, r + 3);
+      __m256d u = _mm256_loadu_pd(&draws[r]);
+      __m256i left = _mm256_slli_epi64(
+          _mm256_cvtepi32_epi64(
+              _mm_loadu_si128(reinterpret_cast<const __m128i *>(&picked[r]))),
+          1);
+      __m256i at = _mm256_add_epi64(_mm256_mul_epu32(left, stride), lane);
+      __m256d leftWeight = _mm256_i64gather_pd(tree, at, 8);
+      __m256d rightWeight =
+          _mm256_i64gather_pd(tree, _mm256_add_epi64(at, stride), 8);
+      __m256d goLeft =
+          _mm256_or_pd(_mm256_cmp_pd(u, leftWeight, _CMP_LT_OQ),
+                       _mm256_cmp_pd(rightWeight, zero, _CMP_EQ_OQ));
+      _mm256_storeu_pd(&draws[r], _mm256_blendv_pd(
+                                      _mm256_sub_pd(u, leftWeight), u, goLeft));
+      __m256i node = _mm256_add_epi64(
+          left, _mm256_andnot_si256(_mm256_castpd_si256(goLeft), one));
+      // Back to 32 bits: the low halves of the four 64-bit lanes
+      __m256i packed = _mm256_permutevar8x32_epi32(
+          node, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(&picked[r]),
+                       _mm256_castsi256_si128(packed));
+    }
+  }
+  for (int r = 0; r < 4 * groups; ++r)
+    picked[r] -= capacity;
+
+  // Remaining replicas, as sampleLinks
+  std::size_t scalarStride = count;
+  for (int r = 4 * groups; r < count; ++r) {
+    double u = draws[r];
+    std::size_t node = 1;
+    while (node < static_cast<std::size_t>(capacity)) {
+      std::size_t left = 2 * node;
+      double leftWeight = tree[left * scalarStride + r];
+      if (u < leftWeight || tree[(left + 1) * scalarStride + r] == 0.0) {
+        node = left;
+      } else {
+        u -= leftWeight;
+        node = left + 1;
+      }
+    }
+    picked[r] = static_cast<int>(node) - capacity;
+  }
+}
+
+__attribute__((target("avx2"))) void ReplicaEnsemble::updatePathsAvx2() {
+  double *tree = trees.data();
+  std::size_t stride = count;
+  const __m256i strideVector = _mm256_set1_epi64x(count);
+  int first = capacity + links - 2;
+  for (int shift = 1; (capacity >> shift) >= 1; ++shift) {
+    // Paths of the picked links: gather both children, store the sums
+    int r = 0;
+    for (; r + 4 <= count; r += 4) {
+      __m256i lane = _mm256_setr_epi64x(r, r + 1, r + 2, r + 3);
+      __m256i leaf = _mm256_add_epi64(
+          _mm256_cvtepi32_epi64(_mm_loadu_si128(
+              reinterpret_cast<const __m128i *>(&picked[r]))),
+          _mm256_set1_epi64x(capacity));
+      __m256i node = _mm256_srli_epi64(leaf, shift);
+      __m256i left = _mm256_add_epi64(
+          _mm256_mul_epu32(_mm256_add_epi64(node, node), strideVector), lane);
+      __m256d sum = _mm256_add_pd(
+          _mm256_i64gather_pd(tree, left, 8),
+          _mm256_i64gather_pd(tree, _mm256_add_epi64(left, strideVector), 8));
+      alignas(32) long long at[4];
+      alignas(32) double value[4];
+      _mm256_store_si256(
+          reinterpret_cast<__m256i *>(at),
+          _mm256_add_epi64(_mm256_mul_epu32(node, strideVector), lane));
+      _mm256_store_pd(value, sum);
+      for (int l = 0; l < 4; ++l)
+        tree[at[l]] = value[l];
+    }
+    for (; r < count; ++r) {
+      std::size_t node = (capacity + picked[r]) >> shift;
+      tree[node * stride + r] =
+          tree[2 * node * stride + r] + tree[(2 * node + 1) * stride + r];
+    }
+
+    // Paths of the two new links: the same node in every tree, contiguous
+    for (int leaf : {first, first + 1}) {
+      std::size_t node = leaf >> shift;
+      if (leaf == first + 1 && node == static_cast<std::size_t>(first >> shift))
+        continue;
+      double *sum = &tree[node * stride];
+      const double *left = &tree[2 * node * stride];
+      const double *right = left + stride;
+      int q = 0;
+      for (; q + 4 <= count; q += 4)
+        _mm256_storeu_pd(sum + q, _mm256_add_pd(_mm256_loadu_pd(left + q),
+                                                _mm256_loadu_pd(right + q)));
+      for (; q < count; ++q)
+        sum[q] = left[q] + right[q];
+    }
+  }
+}
+#else
+void ReplicaEnsemble::sampleLinksAvx2() { sampleLinks(); }
+void ReplicaEnsemble::updatePathsAvx2() { updatePaths(); }
+#endif
+
+void ReplicaEnsemble::replay(int replica, Network &net) const {
+  if (net.numNodes() != 0)
+    throw std::invalid_argument("ReplicaEnsemble::replay needs an empty "
+                                "network");
+  net.reserve(numTriangles());
+  for (int node = 0; node < 3; ++node)
+    net.addNode(nodeEnergy(replica, node));
+  net.addTriangle(0, 1, 2);
+  for (int s = 0; s < steps; ++s) {
+    int node = net.addNode(nodeEnergy(replica, 3 + s));
+    net.attachTriangle(attached[static_cast<std::size_t>(s) * count + replica],
+                       node, RuntimeStatistics{net.m}, RuntimeEnergy{&net});
+  }
+  net.rng = rngs[replica];
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "growth_policies.hpp"
+#include "link.hpp"
+#include "metrics.hpp"
+
+#include <random>
+#include <vector>
+
+class Network;
+
+// K replicas of one (statistics, β, energy, λ) point, differing only in
+// their seed, grown in lockstep: every call of grow() advances all of them
+// by the same number of steps. Every growth step adds one node and two
+// links, so all replicas always have the same numbers of nodes and links
+// and their data is stored structure-of-arrays, replica-minor:
+//   field[index * replicas() + replica]
+// for node fields, link fields and the segment trees of the link samplers,
+// which therefore share one capacity. The per-step tree work (link draws,
+// leaf weights, sums along three paths) is done for all replicas at once,
+// with AVX2 gathers where the CPU has them.
+//
+// Each replica draws from its own std::mt19937 seeded like Network, in the
+// same order as GrowthEngine with the compiled kernels (link, then node
+// energy) and the LinkTree sampler, and the trees are summed exactly like
+// LinkSampler. Replica r is therefore bit-identical to a single run with
+// seeds[r]: same links, same rng state, and the maximum distance, k_max and
+// entropy rate MetricsTracker reports at every step.
+class ReplicaEnsemble {
+public:
+  // m and the energy function as in selectGrowthKernel (Fermi-Dirac m = 2,
+  // Bose-Einstein m = INT_MAX, other m at run time)
+  ReplicaEnsemble(const std::vector<int> &seeds, int m, double beta,
+                  bool quadraticEnergy, int lambda = 5);
+
+  void initialize();       // seed triangle of every replica (t = 1)
+  void grow(int steps);    // throws like GrowthEngine if growth stops
+  void reserve(int numTriangles); // no reallocation up to numTriangles
+
+  // Uses the scalar lockstep loops even where AVX2 is available; results
+  // are identical either way (for benchmarks)
+  void setVectorized(bool enabled) { vectorized = enabled && hasAvx2; }
+  bool isVectorized() const { return vectorized; }
+
+  int replicas() const { return count; }
+  int numNodes() const { return nodes; }
+  int numLinks() const { return links; }
+  int numTriangles() const { return steps + 1; } // same for every replica
+
+  int seed(int replica) const { return seeds[replica]; }
+  int nodeEnergy(int replica, int node) const {
+    return nodeEnergies[node * count + replica];
+  }
+  Link link(int replica, int index) const;
+
+  // MetricsTracker's values for this replica
+  int maxDistance(int replica) const { return maxDist[replica]; }
+  int maxDegree(int replica) const { return kMax[replica]; }
+  double entropyRate(int replica) const { return sums[replica].entropyRate(); }
+
+  // Rebuilds replica `replica` in a fresh network constructed like a single
+  // run (seed, m, β and energy function): the result equals the network
+  // that single run grows, rng included, so it can be measured or exported
+  void replay(int replica, Network &net) const;
+
+  std::size_t memoryBytes() const; // heap held by the ensemble
+
+private:
+  int count;
+  int m;
+  double beta;
+  bool quadratic;
+  std::vector<int> seeds;
+  bool hasAvx2;
+  bool vectorized;
+
+  std::vector<std::mt19937> rngs;
+  std::vector<std::poisson_distribution<int>> energyDraws;
+  BoltzmannFactors boltzmannFactors; // cached e^{-βε}, as in Network
+
+  int nodes = 0;
+  int links = 0;
+  int steps = 0;       // growth steps since initialize()
+  int capacity = 0;    // leaves per tree (power of two)
+  std::vector<int> nodeEnergies, nodeDegrees, nodeDistances;
+  std::vector<int> linkNodes1, linkNodes2, linkEnergies, linkTriangles;
+  std::vector<double> trees; // trees[node * count + r], root node 1
+  std::vector<int> attached; // attached[step * count + r] = link of step
+
+  std::vector<int> maxDist, kMax;
+  std::vector<EnergyLevelSums> sums;
+
+  // Per-step scratch, one entry per replica
+  std::vector<double> draws; // u · Z of the link draw
+  std::vector<int> picked;   // link the new triangle attaches to
+  std::vector<int> omegas;   // energy of the new node
+  std::vector<int> ends;     // (i, j) of the picked link
+  std::vector<int> energies; // ε of the picked link and of the new links
+
+  int linkEnergy(int omega_i, int omega_j) const;
+  void growTrees(int newCapacity); // larger capacity, sums rebuilt
+
+  template <class Statistics>
+  void growSteps(int steps, const Statistics &statistics);
+  // Descends every tree with its draw: draws -> picked
+  void sampleLinks();
+  void sampleLinksAvx2();
+  // Recomputes the sums above the leaves of picked and of the two newest
+  // links, level by level, so each sum is taken from final children
+  void updatePaths();
+  void updatePathsAvx2();
+};
@@ -0,0 +1,340 @@
+#include "simplicial_network.hpp"
+#include "csv_writer.hpp"
+#include "profiler.hpp"
+
+#include <algorithm> // for min, max, sort
+#include <cmath> // for exp
+#include <iostream>
+#include <stdexcept>
+#include <utility> // for index_sequence
+
+namespace {
+// Mixes the D sorted node ids of a face into a 64-bit hash: one multiply
+// per node, unrolled at compile time, then the splitmix64 finalizer
+template <int D, std::size_t... I>
+std::uint64_t hashFaceKey(const std::array<int, D> &nodes,
+                          std::index_sequence<I...>) {
+  std::uint64_t x = 0;
+  ((x = (x ^ static_cast<std::uint32_t>(nodes[I])) * 0x9e3779b97f4a7c15ULL),
+   ...);
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+template <int D> std::uint64_t hashFaceKey(const std::array<int, D> &nodes) {
+  return hashFaceKey<D>(nodes, std::make_index_sequence<D>());
+}
+
+// C(n, k) for the δ-face counts of the curvature
+constexpr double binomial(int n, int k) {
+  double c = 1.0;
+  for (int i = 1; i <= k; ++i)
+    c = c * (n - k + i) / i;
+  return c;
+}
+} // namespace
+
+template <int D>
+SimplicialNetwork<D>::SimplicialNetwork(int seed, int maxSimplices,
+                                        double betaVal)
+    : m(maxSimplices), beta(betaVal), sums(betaVal) {
+  rng.seed(seed);
+}
+
+template <int D> void SimplicialNetwork<D>::initialize() {
+  // D + 1 nodes with energies from this network's rng, as Network does for
+  // its seed triangle, and their D + 1 faces in lexicographic order
+  std::uniform_int_distribution<int> seedEnergy(0, 9);
+  for (int v = 0; v <= D; ++v)
+    addNode(seedEnergy(rng));
+
+  RuntimeStatistics statistics{m};
+  for (int skip = D; skip >= 0; --skip) {
+    FaceNodes nodes;
+    for (int v = 0, k = 0; v <= D; ++v) {
+      if (v != skip)
+        nodes[k++] = v;
+    }
+    createFace(nodes, statistics);
+  }
+  if constexpr (D > 2) {
+    for (int u = 0; u <= D; ++u) {
+      for (int v = u + 1; v <= D; ++v)
+        addEdge(u, v);
+    }
+  }
+  simplexTotal = 1;
+  for (int v = 0; v <= D; ++v)
+    nodeSimplices[v] = 1; // every node at distance 0
+  kMax = D;
+}
+
+template <int D> int SimplicialNetwork<D>::addNode(int energy) {
+  int id = static_cast<int>(nodeEnergies.size());
+  nodeEnergies.push_back(energy);
+  nodeDegrees.push_back(0);
+  nodeSimplices.push_back(0);
+  nodeDistance.push_back(0);
+  return id;
+}
+
+template <int D> void SimplicialNetwork<D>::reserve(int numSimplices) {
+  // Every simplex after the first adds one node and D faces
+  std::size_t extra = numSimplices > 0 ? numSimplices - 1 : 0;
+  std::size_t nodes = D + 1 + extra;
+  for (std::vector<int> *counter :
+       {&nodeEnergies, &nodeDegrees, &nodeSimplices, &nodeDistance})
+    counter->reserve(nodes);
+  faces.reserve(D + 1 + D * extra);
+  sampler.reserve(static_cast<int>(D + 1 + D * extra));
+  if constexpr (D > 2)
+    edges.reserve(D * (D + 1) / 2 + D * extra);
+
+  std::size_t capacity = faceSlots.empty() ? 16 : faceSlots.size();
+  while (capacity < 2 * faces.capacity())
+    capacity *= 2;
+  if (capacity != faceSlots.size())
+    rebuildFaceSlots(capacity);
+}
+
+template <int D> std::size_t SimplicialNetwork<D>::memoryBytes() const {
+  return (nodeEnergies.capacity() + nodeDegrees.capacity() +
+          nodeSimplices.capacity() + nodeDistance.capacity() +
+          faceSlots.capacity()) *
+             sizeof(int) +
+         faces.capacity() * sizeof(Face<D>) +
+         edges.capacity() * sizeof(std::array<int, 2>) + sampler.bytes();
+}
+
+template <int D> int SimplicialNetwork<D>::numEdges() const {
+  if constexpr (D == 2)
+    return numFaces();
+  else
+    return static_cast<int>(edges.size());
+}
+
+template <int D>
+double SimplicialNetwork<D>::faceWeight(const Face<D> &face) const {
+  if (face.numSimplices >= m)
+    return 0.0;
+  return std::exp(-beta * face.energy) * (1 + face.numSimplices);
+}
+
+template <int D> int SimplicialNetwork<D>::findFace(FaceNodes nodes) const {
+  if (faceSlots.empty())
+    return -1;
+  std::sort(nodes.begin(), nodes.end());
+  std::size_t mask = faceSlots.size() - 1;
+  for (std::size_t slot = hashFaceKey<D>(nodes) & mask;;
+       slot = (slot + 1) & mask) {
+    int k = faceSlots[slot];
+    if (k < 0)
+      return -1;
+    if (faces[k].nodes == nodes)
+      return k;
+  }
+}
+
+template <int D>
+void SimplicialNetwork<D>::rebuildFaceSlots(std::size_t capacity) {
+  faceSlots.assign(capacity, -1);
+
+  std::size_t mask = capacity - 1;
+  for (int k = 0; k < (int)faces.size(); ++k) {
+    std::size_t slot = hashFaceKey<D>(faces[k].nodes) & mask;
+    while (faceSlots[slot] >= 0)
+      slot = (slot + 1) & mask;
+    faceSlots[slot] = k;
+  }
+}
+
+template <int D>
+template <class Statistics>
+double SimplicialNetwork<D>::growthWeight(const Face<D> &face,
+                                          const Statistics &statistics) {
+  // Same value as faceWeight(face), with e^{-βε} looked up: the weight of
+  // Network::growthWeight, so d = 2 draws match Network's
+  return attachmentWeight(statistics, boltzmannFactors, beta, face.energy,
+                          face.numSimplices);
+}
+
+template <int D>
+template <class Statistics>
+void SimplicialNetwork<D>::createFace(const FaceNodes &nodes,
+                                      const Statistics &statistics) {
+  Face<D> face;
+  face.nodes = nodes;
+  for (int v : nodes)
+    face.energy += nodeEnergies[v]; // ε_f = Σ ω
+  face.numSimplices = 1;            // the simplex that creates it
+  int k = static_cast<int>(faces.size());
+  faces.push_back(face);
+  sampler.add(growthWeight(face, statistics)); // index == face index
+  if (!statistics.saturated(face.numSimplices))
+    sums.add(face.energy, 1 + face.numSimplices);
+
+  // Keep the load factor of the open-addressing table at most 1/2
+  if (2 * faces.size() > faceSlots.size()) {
+    rebuildFaceSlots(faceSlots.empty() ? 16 : 2 * faceSlots.size());
+  } else {
+    std::size_t mask = faceSlots.size() - 1;
+    std::size_t slot = hashFaceKey<D>(nodes) & mask;
+    while (faceSlots[slot] >= 0)
+      slot = (slot + 1) & mask;
+    faceSlots[slot] = k;
+  }
+
+  if constexpr (D == 2)
+    addEdge(nodes[0], nodes[1]); // the face is the link
+}
+
+template <int D> void SimplicialNetwork<D>::addEdge(int u, int v) {
+  if constexpr (D > 2)
+    edges.push_back({u, v});
+  nodeDegrees[u]++;
+  nodeDegrees[v]++;
+}
+
+template <int D>
+template <class Statistics>
+void SimplicialNetwork<D>::attachSimplex(int index, int r,
+                                         const Statistics &statistics) {
+  ProfileScope scope(ProfilePhase::AddTriangle);
+  FaceNodes nodes = faces[index].nodes; // copy: createFace may reallocate
+
+  simplexTotal++;
+  for (int v : nodes)
+    nodeSimplices[v]++;
+  nodeSimplices[r]++;
+
+  Face<D> &face = faces[index];
+  int old = face.numSimplices++;
+  sampler.update(index, growthWeight(face, statistics)); // 0 once saturated
+  if (!statistics.saturated(old))
+    sums.remove(face.energy, 1 + old);
+  if (!statistics.saturated(face.numSimplices))
+    sums.add(face.energy, 1 + face.numSimplices);
+
+  // The D new faces hold r and all but one node of the face, dropping the
+  // last node first: for D = 2 that is (i,r) then (j,r), as in Network.
+  // r is the largest id, so appending it keeps each face sorted.
+  for (int skip = D - 1; skip >= 0; --skip) {
+    FaceNodes created;
+    for (int v = 0, k = 0; v < D; ++v) {
+      if (v != skip)
+        created[k++] = nodes[v];
+    }
+    created[D - 1] = r;
+    createFace(created, statistics);
+  }
+  if constexpr (D > 2) {
+    for (int v : nodes)
+      addEdge(v, r);
+  }
+
+  // r never shortens an existing path (see MetricsTracker)
+  int closest = nodeDistance[nodes[0]];
+  for (int v : nodes)
+    closest = std::min(closest, nodeDistance[v]);
+  nodeDistance[r] = 1 + closest;
+  maxDist = std::max(maxDist, nodeDistance[r]);
+  kMax = std::max(kMax, nodeDegrees[r]);
+  for (int v : nodes)
+    kMax = std::max(kMax, nodeDegrees[v]);
+}
+
+template <int D> double SimplicialNetwork<D>::nodeCurvature(int node) const {
+  // A node in s + 1 D-simplices lies in C(D,δ) + s C(D-1,δ-1) δ-faces: its
+  // first simplex holds C(D,δ) of them, and each later one, glued to a face
+  // through the node, adds those with the new node. n_1 is the degree.
+  double s = nodeSimplices[node] - 1;
+  double R = 1.0 - (nodeDegrees[node] / 2.0);
+  for (int delta = 2; delta < D; ++delta) {
+    double count = binomial(D, delta) + s * binomial(D - 1, delta - 1);
+    R += (delta % 2 == 0 ? count : -count) / (delta + 1.0);
+  }
+  double top = nodeSimplices[node] / (D + 1.0); // n_D
+  return D % 2 == 0 ? R + top : R - top;
+}
+
+template <int D>
+void SimplicialNetwork<D>::exportEdgeList(const std::string &filename) const {
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(filename);
+  out << "Source,Target\n";
+
+  if constexpr (D == 2) {
+    for (const Face<D> &face : faces)
+      out << face.nodes[0] << ',' << face.nodes[1] << '\n';
+  } else {
+    for (const std::array<int, 2> &edge : edges)
+      out << edge[0] << ',' << edge[1] << '\n';
+  }
+
+  out.close();
+}
+
+template <int D>
+void SimplicialNetwork<D>::exportNodeCurvatures(
+    const std::string &filename) const {
+  ProfileScope scope(ProfilePhase::Export);
+  CsvWriter out(filename);
+  out << "Node,Curvature\n";
+
+  for (int i = 0; i < numNodes(); ++i)
+    out << i << ',' << nodeCurvature(i) << '\n';
+
+  out.close();
+}
+
+// ---- SimplicialGrowthEngine ----
+
+template <int D>
+SimplicialGrowthEngine<D>::SimplicialGrowthEngine(SimplicialNetwork<D> &network,
+                                                  int lambda)
+    : net(network), poissonDist(lambda) {}
+
+template <int D> void SimplicialGrowthEngine<D>::growSteps(int steps) {
+  if (net.m == FermiDirac<2>::maxTriangles)
+    growSteps(steps, FermiDirac<2>{});
+  else if (net.m == BoseEinstein::maxTriangles)
+    growSteps(steps, BoseEinstein{});
+  else
+    growSteps(steps, RuntimeStatistics{net.m});
+}
+
+template <int D>
+template <class Statistics>
+void SimplicialGrowthEngine<D>::growSteps(int steps,
+                                          const Statistics &statistics) {
+  // A short capacity is at least doubled (as GrowthEngine::reserveSteps)
+  int needed = net.numSimplices() + steps;
+  if (needed > net.reservedSimplices())
+    net.reserve(std::max(needed, 2 * net.numSimplices()));
+  for (int s = 0; s < steps; ++s) {
+    // Same draws, in the same order, as GrowthEngine::step
+    if (net.sampler.total() == 0.0 || net.numFaces() == 0) {
+      std::cout << "⚠️ No valid faces available for growth (Z = 0). Hanging "
+                   "prevented.\n";
+      throw std::runtime_error("No possible growth steps (Z = 0).");
+    }
+    int face;
+    {
+      ProfileScope scope(ProfilePhase::SampleLink);
+      face = net.sampler.sample(net.rng);
+    }
+    int ω = poissonDist(net.rng);
+    net.attachSimplex(face, net.addNode(ω), statistics);
+  }
+}
+
+template class SimplicialNetwork<2>;
+template class SimplicialNetwork<3>;
+template class SimplicialNetwork<4>;
+template class SimplicialGrowthEngine<2>;
+template class SimplicialGrowthEngine<3>;
+template class SimplicialGrowthEngine<4>;
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "growth_policies.hpp"
+#include "link_sampler.hpp"
+#include "metrics.hpp"
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Network geometry with flavor in dimension D: D-simplices glued along their
+// (D-1)-faces. Every step attaches a new D-simplex, i.e. one new node r, to
+// a face drawn with P(f) ∝ e^{-βε_f}(1+n_f), where ε_f = Σ ω over the face's
+// nodes and n_f counts the D-simplices on it; a face holds at most m of them
+// (FermiDirac<2> or BoseEinstein, as links do in Network).
+//
+// D is a template parameter so faces are fixed-size arrays and every loop
+// over a face unrolls. SimplicialNetwork<2> grows exactly as Network with
+// the linear energy: faces are its links, in the same order, drawn from the
+// same rng, so links, node counters, curvatures and the tracked metrics are
+// bit-identical. Network stays the d = 2 model of quantum_net (snapshots,
+// event logs, lean storage and the full Metrics); this class runs
+// --dimension 3 and 4 (instantiated in simplicial_network.cpp for D = 2..4).
+template <int D> struct Face {
+  std::array<int, D> nodes; // increasing node ids
+  int energy = 0;           // ε_f = Σ ω_i
+  int numSimplices = 0;     // n_f: D-simplices incident to the face
+};
+
+template <int D> class SimplicialNetwork {
+  static_assert(D >= 2, "faces of a D-simplex need D >= 2 nodes");
+
+public:
+  using FaceNodes = std::array<int, D>;
+
+  int m = 2;         // max D-simplices per face
+  double beta = 0.0; // inverse temperature
+  std::mt19937 rng;  // random number generator
+
+  // Growth weights of all faces (index = face index), kept up to date
+  LinkSampler sampler;
+
+  SimplicialNetwork(int seed = 42, int maxSimplices = 2,
+                    double betaVal = 0.0);
+
+  // Networks of millions of faces are passed by reference only
+  SimplicialNetwork(const SimplicialNetwork &) = delete;
+  SimplicialNetwork &operator=(const SimplicialNetwork &) = delete;
+
+  void initialize();       // t=1: seed simplex on nodes 0..D
+  int addNode(int energy); // adds node with energy ω
+  // Attaches a D-simplex with new node r to face `face`, updating the
+  // sampler and the tracked metrics; statistics must describe m
+  template <class Statistics>
+  void attachSimplex(int face, int r, const Statistics &statistics);
+
+  // Preallocates storage for growth up to numSimplices D-simplices
+  void reserve(int numSimplices);
+  // D-simplices the network can hold without reallocating its node storage
+  int reservedSimplices() const {
+    return static_cast<int>(nodeEnergies.capacity()) - D;
+  }
+  std::size_t memoryBytes() const; // heap held by the containers
+
+  int numNodes() const { return static_cast<int>(nodeEnergies.size()); }
+  int nodeEnergy(int node) const { return nodeEnergies[node]; }
+  int numSimplices() const { return simplexTotal; }
+  int numFaces() const { return static_cast<int>(faces.size()); }
+  const Face<D> &getFace(int index) const { return faces[index]; }
+  int findFace(FaceNodes nodes) const; // face index, -1 if absent
+  int numEdges() const; // links of the 1-skeleton
+  int degree(int node) const { return nodeDegrees[node]; }
+  int simplexCount(int node) const { return nodeSimplices[node]; }
+  double faceWeight(const Face<D> &face) const; // 0 if saturated
+
+  // Node curvature R_i = Σ_{δ=0..D} (-1)^δ n_δ(i) / (δ+1), n_δ(i) the
+  // δ-faces containing i; for D = 2, 1 - k/2 + T/3 as in Network
+  double nodeCurvature(int node) const;
+
+  // Metrics kept while growing, O(1) to read (as MetricsTracker)
+  int maxDistanceFromInitialSimplex() const { return maxDist; }
+  int maxDegree() const { return kMax; }
+  double partitionFunction() const { return sums.partitionFunction(); }
+  double entropyRate() const { return sums.entropyRate(); }
+
+  void exportEdgeList(const std::string &filename) const; // Source,Target
+  void exportNodeCurvatures(const std::string &filename) const;
+
+private:
+  std::vector<int> nodeEnergies;  // ω_i
+  std::vector<int> nodeDegrees;   // 1-skeleton links incident to node i
+  std::vector<int> nodeSimplices; // D-simplices incident to node i
+  std::vector<int> nodeDistance;  // hops from the seed simplex
+  std::vector<Face<D>> faces;     // faces[k] = k-th created face
+  std::vector<int> faceSlots;     // open addressing: nodes -> k
+  // Links of the 1-skeleton in creation order; for D = 2 they are the
+  // faces, and this stays empty
+  std::vector<std::array<int, 2>> edges;
+  int simplexTotal = 0;
+
+  int maxDist = 0;
+  int kMax = 0;
+  EnergyLevelSums sums; // Z and Σ w log w over unsaturated faces
+
+  BoltzmannFactors boltzmannFactors; // cached e^{-βε}, as in Network
+
+  template <class Statistics>
+  double growthWeight(const Face<D> &face, const Statistics &statistics);
+  template <class Statistics>
+  void createFace(const FaceNodes &nodes, const Statistics &statistics);
+  void addEdge(int u, int v);
+  void rebuildFaceSlots(std::size_t capacity); // reinserts every face
+};
+
+// Grows a SimplicialNetwork like GrowthEngine grows a Network: draw a face,
+// draw ω from Poisson(λ), attach a D-simplex with a new node of energy ω.
+template <int D> class SimplicialGrowthEngine {
+public:
+  SimplicialGrowthEngine(SimplicialNetwork<D> &network, int lambda = 5);
+
+  // Performs `steps` growth steps with the policy compiled for the
+  // network's m (FermiDirac<2>, BoseEinstein, else run-time m). Throws
+  // std::runtime_error if growth stops (Z = 0).
+  void growSteps(int steps);
+
+private:
+  SimplicialNetwork<D> &net;
+  std::poisson_distribution<int> poissonDist;
+
+  template <class Statistics>
+  void growSteps(int steps, const Statistics &statistics);
+};
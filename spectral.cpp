@@ -0,0 +1,413 @@
+#include "spectral.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kMinRowsPerThread = 4096; // smaller blocks cost more to spawn
+
+double dot(const std::vector<double> &a, const std::vector<double> &b) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < a.size(); ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+// e^{-z} I_n(z) for n = 0..nmax by Miller's backward recurrence
+// I_{k-1} = (2k / z) I_k + I_{k+1}, normalized with e^z = I_0 + 2 Σ I_k.
+// Scaled values never overflow, whatever z.
+std::vector<double> scaledBesselI(double z, int nmax) {
+  std::vector<double> result(nmax + 1, 0.0);
+  if (z <= 0.0) {
+    result[0] = 1.0;
+    return result;
+  }
+
+  int start =
+      static_cast<int>(std::max<double>(nmax, z + 10.0 * std::sqrt(z))) + 30;
+  double above = 0.0;      // I_{k+1}
+  double current = 1e-280; // I_k, arbitrary scale
+  double sum = 0.0;        // 2 Σ_{j > k} I_j
+  for (int k = start; k >= 1; --k) {
+    if (k <= nmax)
+      result[k] = current;
+    sum += 2.0 * current;
+    double below = (2.0 * k / z) * current + above;
+    above = current;
+    current = below;
+    if (current > 1e250) {
+      above *= 1e-250;
+      current *= 1e-250;
+      sum *= 1e-250;
+      for (int j = k; j <= nmax; ++j)
+        result[j] *= 1e-250;
+    }
+  }
+  result[0] = current;
+  sum += current;
+  for (double &r : result)
+    r /= sum;
+  return result;
+}
+
+// Eigenvalues of the symmetric tridiagonal matrix (diagonal d, off-diagonal
+// e[i] between i and i+1) by implicit QL, in place. `row` is a row of the
+// eigenvector matrix, rotated along (start with a unit vector).
+void tridiagonalEigen(std::vector<double> &d, std::vector<double> e,
+                      std::vector<double> &row) {
+  int n = static_cast<int>(d.size());
+  e.resize(n, 0.0);
+  e[n - 1] = 0.0;
+  const double eps = std::numeric_limits<double>::epsilon();
+
+  for (int l = 0; l < n; ++l) {
+    int iterations = 0;
+    int m;
+    do {
+      for (m = l; m < n - 1; ++m) {
+        double dd = std::abs(d[m]) + std::abs(d[m + 1]);
+        if (std::abs(e[m]) <= eps * dd)
+          break;
+      }
+      if (m == l || iterations++ == 60)
+        break;
+
+      double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+      double r = std::hypot(g, 1.0);
+      g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+      double s = 1.0, c = 1.0, p = 0.0;
+      int i;
+      for (i = m - 1; i >= l; --i) {
+        double f = s * e[i];
+        double b = c * e[i];
+        e[i + 1] = r = std::hypot(f, g);
+        if (r == 0.0) {
+          d[i + 1] -= p;
+          e[m] = 0.0;
+          break;
+        }
+        s = f / r;
+        c = g / r;
+        g = d[i + 1] - p;
+        r = (d[i] - g) * s + 2.0 * c * b;
+        d[i + 1] = g + (p = s * r);
+        g = c * r - b;
+        double z = row[i + 1];
+        row[i + 1] = s * row[i] + c * z;
+        row[i] = c * row[i] - s * z;
+      }
+      if (r == 0.0 && i >= l)
+        continue;
+      d[l] -= p;
+      e[l] = g;
+      e[m] = 0.0;
+    } while (m != l);
+  }
+}
+} // namespace
+
+double SparseLaplacian::upperBound() const {
+  if (kind == LaplacianKind::Normalized)
+    return 2.0; // always, and tighter than Gershgorin around hubs
+  double bound = 0.0;
+  for (int i = 0; i < size(); ++i) {
+    double radius = std::abs(diagonal[i]);
+    for (int k = offsets[i]; k < offsets[i + 1]; ++k)
+      radius += std::abs(scaling[i] * scaling[targets[k]]);
+    bound = std::max(bound, radius);
+  }
+  return bound;
+}
+
+std::vector<double> SparseLaplacian::nullVector() const {
+  std::vector<double> v(size(), 1.0);
+  if (kind == LaplacianKind::Normalized) {
+    for (int i = 0; i < size(); ++i)
+      v[i] = std::sqrt(static_cast<double>(offsets[i + 1] - offsets[i]));
+  }
+  double norm = std::sqrt(dot(v, v));
+  for (double &x : v)
+    x = norm > 0.0 ? x / norm : 0.0;
+  return v;
+}
+
+void SparseLaplacian::multiply(const std::vector<double> &x,
+                               std::vector<double> &y, int threads) const {
+  int rows = size();
+  y.resize(rows);
+  // y_i = L_ii x_i - s_i Σ_j s_j x_j; the unit weights skip the s_j loads
+  auto block = [&](int begin, int end) {
+    const int *offset = offsets.data();
+    const int *column = targets.data();
+    const double *s = scaling.data();
+    const double *in = x.data();
+    double *out = y.data();
+    for (int i = begin; i < end; ++i) {
+      double sum = 0.0;
+      if (kind == LaplacianKind::Combinatorial) {
+        for (int k = offset[i]; k < offset[i + 1]; ++k)
+          sum += in[column[k]];
+      } else {
+        for (int k = offset[i]; k < offset[i + 1]; ++k)
+          sum += s[column[k]] * in[column[k]];
+      }
+      out[i] = diagonal[i] * in[i] - s[i] * sum;
+    }
+  };
+
+  threads = std::max(1, std::min(threads, rows / kMinRowsPerThread));
+  if (threads == 1) {
+    block(0, rows);
+    return;
+  }
+
+  // Row i ends at work offsets[i+1] + (i+1): its nonzeros plus the diagonal
+  std::vector<int> cut(threads + 1, rows);
+  cut[0] = 0;
+  long long work = static_cast<long long>(offsets[rows]) + rows;
+  for (int t = 1; t < threads; ++t) {
+    long long target = work * t / threads;
+    int lo = cut[t - 1], hi = rows;
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (static_cast<long long>(offsets[mid]) + mid < target)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    cut[t] = lo;
+  }
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(block, cut[t], cut[t + 1]);
+  block(cut[0], cut[1]);
+  for (std::thread &t : pool)
+    t.join();
+}
+
+KernelPolynomial::KernelPolynomial(const SparseLaplacian &laplacian,
+                                   int numMoments, int numVectors,
+                                   int threads, unsigned seed)
+    : scale(0.0), n(laplacian.size()), vectors(std::max(1, numVectors)) {
+  numMoments = std::max(2, numMoments);
+  numVectors = vectors;
+  mu.assign(numMoments, 0.0);
+  if (n == 0)
+    return;
+  // A little headroom keeps the spectrum of L̃ strictly inside [-1, 1]
+  scale = std::max(laplacian.upperBound(), 1e-12) * 0.5 * 1.01;
+
+  // L̃ v = L v / a - v; T_{k+1} = 2 L̃ T_k - T_{k-1}. With the doubling
+  // identities T_{2k} = 2 T_k² - T_0 and T_{2k+1} = 2 T_{k+1} T_k - T_1,
+  // M moments cost about M/2 products per vector.
+  std::mt19937 rng(seed);
+  std::vector<double> prev(n), cur(n), next(n), product(n);
+  for (int r = 0; r < numVectors; ++r) {
+    for (double &x : prev)
+      x = (rng() & 1) ? 1.0 : -1.0;
+    laplacian.multiply(prev, product, threads);
+    for (int i = 0; i < n; ++i)
+      cur[i] = product[i] / scale - prev[i];
+
+    double mu0 = dot(prev, prev);
+    double mu1 = dot(cur, prev);
+    mu[0] += mu0;
+    mu[1] += mu1;
+    for (int k = 1; 2 * k < numMoments; ++k) {
+      laplacian.multiply(cur, product, threads);
+      for (int i = 0; i < n; ++i)
+        next[i] = 2.0 * (product[i] / scale - cur[i]) - prev[i];
+      mu[2 * k] += 2.0 * dot(cur, cur) - mu0;
+      if (2 * k + 1 < numMoments)
+        mu[2 * k + 1] += 2.0 * dot(next, cur) - mu1;
+      prev.swap(cur);
+      cur.swap(next);
+    }
+  }
+  for (double &m : mu)
+    m /= static_cast<double>(n) * numVectors;
+}
+
+std::vector<SpectralBin> KernelPolynomial::density(int points) const {
+  int M = static_cast<int>(mu.size());
+  // Jackson kernel: removes the Gibbs oscillations of the truncated series
+  std::vector<double> g(M);
+  double q = kPi / (M + 1);
+  for (int k = 0; k < M; ++k)
+    g[k] = ((M - k + 1) * std::cos(q * k) + std::sin(q * k) / std::tan(q)) /
+           (M + 1);
+
+  std::vector<SpectralBin> bins(std::max(points, 0));
+  for (int p = 0; p < points; ++p) {
+    double lambda = 2.0 * scale * (p + 0.5) / points;
+    double x = lambda / scale - 1.0;
+    double tPrev = 1.0, t = x; // T_0, T_1
+    double sum = g[0] * mu[0];
+    for (int k = 1; k < M; ++k) {
+      sum += 2.0 * g[k] * mu[k] * t;
+      double tNext = 2.0 * x * t - tPrev;
+      tPrev = t;
+      t = tNext;
+    }
+    bins[p].lambda = lambda;
+    bins[p].density = sum / (kPi * std::sqrt(1.0 - x * x) * scale);
+  }
+  return bins;
+}
+
+double KernelPolynomial::maxTime() const {
+  // The terms e^{-z} I_k(z) are negligible for k > z + 10 √z + 10
+  double M = static_cast<double>(mu.size()) - 1.0;
+  if (scale <= 0.0 || M <= 10.0)
+    return 0.0;
+  double root = 0.5 * (-10.0 + std::sqrt(100.0 + 4.0 * (M - 10.0)));
+  return root * root / scale;
+}
+
+double KernelPolynomial::returnProbability(double t) const {
+  if (t > maxTime() * (1.0 + 1e-12))
+    return std::numeric_limits<double>::quiet_NaN();
+  // e^{-tL} = e^{-z} e^{-z L̃}, z = t a, and
+  // e^{-z x} = I_0(z) + 2 Σ_k (-1)^k I_k(z) T_k(x)
+  int M = static_cast<int>(mu.size());
+  std::vector<double> bessel = scaledBesselI(t * scale, M - 1);
+  double sum = bessel[0] * mu[0];
+  for (int k = 1; k < M; ++k)
+    sum += (k % 2 == 0 ? 2.0 : -2.0) * bessel[k] * mu[k];
+  return sum;
+}
+
+std::vector<HeatKernelPoint> KernelPolynomial::heatKernel(double tMin,
+                                                          int points) const {
+  std::vector<HeatKernelPoint> heat;
+  double tMax = maxTime();
+  if (points < 2 || tMin <= 0.0 || tMax <= tMin)
+    return heat;
+
+  double ratio = std::log(tMax / tMin) / (points - 1);
+  for (int p = 0; p < points; ++p) {
+    HeatKernelPoint point;
+    point.t = p + 1 < points ? tMin * std::exp(ratio * p) : tMax;
+    point.returnProbability = returnProbability(point.t);
+    // Var of Hutchinson with ±1 vectors <= 2 ||e^{-tL}||_F² / R and
+    // ||e^{-tL}||_F² = N P(2t) <= N P(t)
+    point.uncertainty = std::sqrt(
+        2.0 * std::max(point.returnProbability, 0.0) / (vectors * n));
+    heat.push_back(point);
+  }
+
+  // Local slope of log(P - 1/N): one-sided at the ends
+  auto logExcess = [&](const HeatKernelPoint &point) {
+    return std::log(point.returnProbability - 1.0 / n);
+  };
+  for (int p = 0; p < points; ++p) {
+    int a = std::max(p - 1, 0);
+    int b = std::min(p + 1, points - 1);
+    heat[p].localDimension = -2.0 * (logExcess(heat[b]) - logExcess(heat[a])) /
+                             std::log(heat[b].t / heat[a].t);
+  }
+  return heat;
+}
+
+double spectralDimension(const std::vector<HeatKernelPoint> &heat, int nodes,
+                         double tMin, double tMax) {
+  double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+  int count = 0;
+  for (const HeatKernelPoint &point : heat) {
+    double excess = point.returnProbability - 1.0 / nodes;
+    if (point.t < tMin || point.t > tMax ||
+        !(excess > 3.0 * point.uncertainty))
+      continue;
+    double x = std::log(point.t);
+    double y = std::log(excess);
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+    count++;
+  }
+  double denominator = count * sxx - sx * sx;
+  if (count < 2 || denominator <= 0.0)
+    return std::numeric_limits<double>::quiet_NaN();
+  return -2.0 * (count * sxy - sx * sy) / denominator;
+}
+
+std::vector<RitzValue> lowEigenvalues(const SparseLaplacian &laplacian,
+                                      int count, int steps, int threads,
+                                      unsigned seed, double tolerance) {
+  int n = laplacian.size();
+  steps = std::min(steps, n - 1);
+  if (count <= 0 || steps < 1)
+    return {};
+
+  std::vector<double> null = laplacian.nullVector();
+  auto deflate = [&](std::vector<double> &v) {
+    double c = dot(v, null);
+    for (int i = 0; i < n; ++i)
+      v[i] -= c * null[i];
+  };
+  double bound = laplacian.upperBound();
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::vector<double> q(n), qPrev(n, 0.0), w(n);
+  for (double &x : q)
+    x = uniform(rng);
+  deflate(q);
+  double norm = std::sqrt(dot(q, q));
+  for (double &x : q)
+    x /= norm;
+
+  std::vector<double> alpha, beta;
+  double b = 0.0;
+  for (int j = 0; j < steps; ++j) {
+    laplacian.multiply(q, w, threads);
+    double a = dot(w, q);
+    for (int i = 0; i < n; ++i)
+      w[i] -= a * q[i] + b * qPrev[i];
+    deflate(w); // rounding slowly reintroduces the λ = 0 mode
+    alpha.push_back(a);
+    b = std::sqrt(dot(w, w));
+    beta.push_back(b);
+    if (b <= 1e-12 * bound)
+      break; // invariant subspace: the Ritz values are exact
+    qPrev.swap(q);
+    for (int i = 0; i < n; ++i)
+      q[i] = w[i] / b;
+  }
+
+  // Ritz values θ_i and residuals |β_m s_{m,i}| (last eigenvector row)
+  int m = static_cast<int>(alpha.size());
+  std::vector<double> theta = alpha;
+  std::vector<double> last(m, 0.0);
+  last[m - 1] = 1.0;
+  tridiagonalEigen(theta, std::vector<double>(beta.begin(), beta.end() - 1),
+                   last);
+
+  std::vector<RitzValue> ritz(m);
+  for (int i = 0; i < m; ++i)
+    ritz[i] = {theta[i], std::abs(beta[m - 1] * last[i])};
+  std::sort(ritz.begin(), ritz.end(),
+            [](const RitzValue &x, const RitzValue &y) {
+              return x.value < y.value;
+            });
+
+  std::vector<RitzValue> converged;
+  for (const RitzValue &r : ritz) {
+    if (r.residual > tolerance * bound)
+      break; // an eigenvalue below the next ones is not resolved yet
+    // Lost orthogonality repeats converged values: keep one copy
+    if (!converged.empty() &&
+        r.value - converged.back().value <= tolerance * bound)
+      continue;
+    converged.push_back(r);
+    if ((int)converged.size() == count)
+      break;
+  }
+  return converged;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+// L = D - A, or the normalized L = I - D^{-1/2} A D^{-1/2} (spectrum in
+// [0, 2], the one used for the spectral dimension)
+enum class LaplacianKind { Combinatorial, Normalized };
+
+// Graph Laplacian in CSR form. Off-diagonal entries are L_ij = -s_i s_j
+// (s = 1, or 1/sqrt(k) normalized), so only the pattern is stored and a
+// mat-vec streams 4 bytes per edge instead of 12.
+struct SparseLaplacian {
+  LaplacianKind kind = LaplacianKind::Normalized;
+  std::vector<int> offsets;     // row i: [offsets[i], offsets[i+1])
+  std::vector<int> targets;     // columns j of the edges of row i
+  std::vector<double> scaling;  // s_i
+  std::vector<double> diagonal; // L_ii
+
+  int size() const { return static_cast<int>(diagonal.size()); }
+  double upperBound() const; // λ_max <= upperBound(): 2, or Gershgorin
+
+  // Unit eigenvector of λ = 0 of a connected graph: ∝ 1 or ∝ D^{1/2} 1
+  std::vector<double> nullVector() const;
+
+  // y = L x. Rows are split over threads in blocks of equal nonzeros, so
+  // hubs do not serialize the product; y does not depend on the threads.
+  void multiply(const std::vector<double> &x, std::vector<double> &y,
+                int threads = 1) const;
+};
+
+struct SpectralBin {
+  double lambda = 0.0;
+  double density = 0.0; // ρ(λ), ∫ρ = 1
+};
+
+struct HeatKernelPoint {
+  double t = 0.0;
+  double returnProbability = 0.0; // P(t) = Tr e^{-tL} / N
+  double uncertainty = 0.0;       // std of the trace estimate, <= √(2P/RN)
+  double localDimension = 0.0;    // -2 dln(P - 1/N) / dln t
+};
+
+struct RitzValue {
+  double value = 0.0;
+  double residual = 0.0; // ||L y - θ y|| for the Ritz vector y
+};
+
+// Kernel polynomial method (Weiße et al. 2006): Chebyshev moments
+// μ_n = Tr T_n(L̃) / N of the rescaled L̃ = L / a - 1, a = upperBound() / 2,
+// estimated from random ±1 vectors (Hutchinson). The density and the heat
+// kernel are then sums over the moments, without any eigen-decomposition.
+class KernelPolynomial {
+public:
+  KernelPolynomial(const SparseLaplacian &laplacian, int numMoments,
+                   int numVectors, int threads = 1, unsigned seed = 42);
+
+  const std::vector<double> &moments() const { return mu; }
+
+  // ρ(λ) at `points` midpoints of [0, upperBound], Jackson-damped
+  std::vector<SpectralBin> density(int points) const;
+
+  // P(t) for log-spaced t in [tMin, maxTime()]
+  std::vector<HeatKernelPoint> heatKernel(double tMin, int points) const;
+  double returnProbability(double t) const; // NaN beyond maxTime()
+  // Largest t whose e^{-tL} expansion the moments resolve
+  double maxTime() const;
+
+private:
+  double scale;           // a
+  int n;                  // nodes
+  int vectors;            // R
+  std::vector<double> mu; // μ_0 .. μ_{M-1}
+};
+
+// d_s from P(t) - 1/N ~ t^{-d_s/2}, least squares in log-log over
+// tMin <= t <= tMax, skipping points where P - 1/N is below three times the
+// uncertainty; NaN with fewer than two usable points
+double spectralDimension(const std::vector<HeatKernelPoint> &heat, int nodes,
+                         double tMin, double tMax);
+
+// The smallest nonzero eigenvalues by Lanczos (no reorthogonalization, the
+// λ = 0 mode of a connected graph projected out), `steps` mat-vecs. Returns
+// the Ritz values from the bottom up while their residual is at most
+// tolerance * upperBound(); copies from lost orthogonality are merged.
+std::vector<RitzValue> lowEigenvalues(const SparseLaplacian &laplacian,
+                                      int count, int steps, int threads = 1,
+                                      unsigned seed = 42,
+                                      double tolerance = 1e-6);
@@ -0,0 +1,111 @@
+#include "sweep_scheduler.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+struct WorkerJob {
+  std::size_t index; // submission order
+  std::function<void()> run;
+};
+
+struct WorkerQueue {
+  std::mutex mutex;
+  std::deque<WorkerJob> jobs;
+};
+} // namespace
+
+SweepScheduler::SweepScheduler(int numThreads_) : numThreads(numThreads_) {
+  if (numThreads <= 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void SweepScheduler::addJob(double cost, std::function<void()> job,
+                            std::string name) {
+  if (name.empty())
+    name = "job " + std::to_string(jobs.size() + 1);
+  jobs.push_back({cost, std::move(job), std::move(name)});
+}
+
+std::vector<std::string> SweepScheduler::run() {
+  std::vector<std::string> names;
+  for (QueuedJob &job : jobs)
+    names.push_back(std::move(job.name));
+  std::vector<std::size_t> order(jobs.size());
+  for (std::size_t k = 0; k < order.size(); ++k)
+    order[k] = k;
+
+  // Longest jobs first; equal costs keep their submission order
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return jobs[a].cost > jobs[b].cost;
+                   });
+
+  int workers = std::max(1, std::min<int>(numThreads, (int)jobs.size()));
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  for (int w = 0; w < workers; ++w)
+    queues.push_back(std::make_unique<WorkerQueue>());
+
+  // Deal round-robin so every worker starts with one of the largest jobs
+  for (std::size_t k = 0; k < order.size(); ++k)
+    queues[k % workers]->jobs.push_back(
+        {order[k], std::move(jobs[order[k]].run)});
+  jobs.clear();
+
+  // errors[k]: what job k threw, empty if it succeeded
+  std::vector<std::string> errors(names.size());
+
+  auto takeJob = [&](int self, WorkerJob &job) {
+    {
+      WorkerQueue &own = *queues[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.jobs.empty()) {
+        job = std::move(own.jobs.front());
+        own.jobs.pop_front();
+        return true;
+      }
+    }
+    for (int offset = 1; offset < workers; ++offset) {
+      WorkerQueue &victim = *queues[(self + offset) % workers];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.jobs.empty()) {
+        job = std::move(victim.jobs.back()); // steal the smallest
+        victim.jobs.pop_back();
+        return true;
+      }
+    }
+    return false; // jobs are never added while running, so we are done
+  };
+
+  auto worker = [&](int self) {
+    WorkerJob job;
+    while (takeJob(self, job)) {
+      try {
+        job.run();
+      } catch (const std::exception &e) {
+        errors[job.index] = e.what();
+        if (errors[job.index].empty())
+          errors[job.index] = "unknown error";
+      } catch (...) {
+        errors[job.index] = "unknown error";
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int w = 1; w < workers; ++w)
+    threads.emplace_back(worker, w);
+  worker(0); // the calling thread works too
+  for (std::thread &t : threads)
+    t.join();
+
+  std::vector<std::string> failures;
+  for (std::size_t k = 0; k < names.size(); ++k)
+    if (!errors[k].empty())
+      failures.push_back(names[k] + ": " + errors[k]);
+  return failures;
+}
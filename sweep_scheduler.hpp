@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs independent jobs on a fixed set of worker threads with work stealing.
+// Jobs are started in order of decreasing estimated cost, so long runs begin
+// first instead of ending up as stragglers. Each worker drains its own deque
+// from the front (largest first) and steals from the back of the others.
+class SweepScheduler {
+public:
+  explicit SweepScheduler(int numThreads = 0); // 0 = hardware concurrency
+
+  // `name` identifies the job in failure reports
+  void addJob(double cost, std::function<void()> job, std::string name = {});
+  std::size_t pendingJobs() const { return jobs.size(); }
+  int threads() const { return numThreads; }
+
+  // Runs every queued job and returns when all are done. A job that throws
+  // does not stop the others: the failures are returned as "<name>: <error>",
+  // in submission order, and are empty if every job succeeded.
+  std::vector<std::string> run();
+
+private:
+  struct QueuedJob {
+    double cost;
+    std::function<void()> run;
+    std::string name;
+  };
+
+  int numThreads;
+  std::vector<QueuedJob> jobs;
+};
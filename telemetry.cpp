@@ -0,0 +1,211 @@
+#include "telemetry.hpp"
+#include "experiment.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+// Resident set size of this process in bytes; 0 where unavailable
+std::size_t residentBytes() {
+#if defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  std::size_t pages = 0, resident = 0;
+  if (statm >> pages >> resident)
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+  return 0;
+}
+
+void writeHelp(std::ostream &out, const char *name, const char *help) {
+  out << "# HELP " << name << ' ' << help << '\n'
+      << "# TYPE " << name << " gauge\n";
+}
+} // namespace
+
+JobProgress::JobProgress(const SimulationJob &job,
+                         std::chrono::steady_clock::time_point epoch_)
+    : series(job.series), beta(job.beta),
+      targetTriangles(job.targetTriangles), seed(job.seed), epoch(epoch_) {}
+
+std::int64_t JobProgress::nanosNow() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch)
+      .count();
+}
+
+void JobProgress::begin(int triangles_) {
+  std::int64_t now = nanosNow();
+  startNanos.store(now, std::memory_order_relaxed);
+  updateNanos.store(now, std::memory_order_relaxed);
+  startTriangles.store(triangles_, std::memory_order_relaxed);
+  triangles.store(triangles_, std::memory_order_relaxed);
+  current.store(JobState::Running, std::memory_order_release);
+}
+
+void JobProgress::update(int triangles_, double partitionFunction_,
+                         double entropyRate_, std::size_t memoryBytes_) {
+  triangles.store(triangles_, std::memory_order_relaxed);
+  partitionFunction.store(partitionFunction_, std::memory_order_relaxed);
+  entropyRate.store(entropyRate_, std::memory_order_relaxed);
+  memoryBytes.store(memoryBytes_, std::memory_order_relaxed);
+  updateNanos.store(nanosNow(), std::memory_order_relaxed);
+}
+
+void JobProgress::finish(bool failed) {
+  current.store(failed ? JobState::Failed : JobState::Done,
+                std::memory_order_release);
+}
+
+Telemetry::Telemetry(std::string filename_, double intervalSeconds)
+    : filename(std::move(filename_)), interval(intervalSeconds),
+      epoch(std::chrono::steady_clock::now()) {}
+
+Telemetry::~Telemetry() { stop(); }
+
+JobProgress *Telemetry::addJob(const SimulationJob &job) {
+  std::lock_guard<std::mutex> lock(mutex);
+  jobs.emplace_back(job, epoch);
+  return &jobs.back();
+}
+
+void Telemetry::start() {
+  if (writer.joinable())
+    return;
+  write();
+  writer = std::thread([this] {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+      lock.unlock();
+      write();
+      lock.lock();
+    }
+  });
+}
+
+void Telemetry::stop() {
+  if (!writer.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  writer.join();
+  write(); // the final state: every job done or failed
+}
+
+std::string Telemetry::prometheusText() const {
+  std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - epoch)
+                         .count();
+  std::ostringstream out;
+  out.precision(10);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  int counts[4] = {0, 0, 0, 0};
+  for (const JobProgress &job : jobs)
+    counts[static_cast<int>(job.state())]++;
+
+  writeHelp(out, "quantum_net_uptime_seconds",
+            "Seconds since the sweep started");
+  out << "quantum_net_uptime_seconds " << now * 1e-9 << '\n';
+  writeHelp(out, "quantum_net_resident_bytes",
+            "Resident memory of the process");
+  out << "quantum_net_resident_bytes " << residentBytes() << '\n';
+  writeHelp(out, "quantum_net_jobs", "Jobs of the sweep by state");
+  const char *states[4] = {"queued", "running", "done", "failed"};
+  for (int s = 0; s < 4; ++s)
+    out << "quantum_net_jobs{state=\"" << states[s] << "\"} " << counts[s]
+        << '\n';
+
+  // Per running job; finished jobs only count above
+  struct Gauge {
+    const char *name;
+    const char *help;
+  };
+  const Gauge gauges[] = {
+      {"quantum_net_job_triangles", "Triangles of the job's network"},
+      {"quantum_net_job_target_triangles", "Triangles the job grows to"},
+      {"quantum_net_job_steps_per_second",
+       "Growth steps per second since the job started"},
+      {"quantum_net_job_eta_seconds", "Estimated seconds to the target"},
+      {"quantum_net_job_partition_function", "Partition function Z"},
+      {"quantum_net_job_entropy_rate", "Entropy rate of the link measure"},
+      {"quantum_net_job_memory_bytes", "Heap held by the job's network"},
+      {"quantum_net_job_last_update_seconds",
+       "Seconds since the job last reported progress"},
+  };
+  std::ostringstream rows[std::size(gauges)];
+  for (std::ostringstream &row : rows)
+    row.precision(10);
+  for (const JobProgress &job : jobs) {
+    if (job.state() != JobState::Running)
+      continue;
+    std::ostringstream labels;
+    labels << "{series=\"" << job.series << "\",beta=\"" << job.beta
+           << "\",N=\"" << job.targetTriangles << "\",seed=\"" << job.seed
+           << "\"} ";
+    int triangles = job.triangles.load(std::memory_order_relaxed);
+    double elapsed =
+        (now - job.startNanos.load(std::memory_order_relaxed)) * 1e-9;
+    double rate =
+        elapsed > 0.0
+            ? (triangles - job.startTriangles.load(std::memory_order_relaxed)) /
+                  elapsed
+            : 0.0;
+    double values[] = {
+        static_cast<double>(triangles),
+        static_cast<double>(job.targetTriangles),
+        rate,
+        rate > 0.0 ? (job.targetTriangles - triangles) / rate
+                   : std::numeric_limits<double>::quiet_NaN(),
+        job.partitionFunction.load(std::memory_order_relaxed),
+        job.entropyRate.load(std::memory_order_relaxed),
+        static_cast<double>(job.memoryBytes.load(std::memory_order_relaxed)),
+        (now - job.updateNanos.load(std::memory_order_relaxed)) * 1e-9,
+    };
+    for (std::size_t g = 0; g < std::size(gauges); ++g) {
+      rows[g] << gauges[g].name << labels.str();
+      if (std::isnan(values[g]))
+        rows[g] << "NaN\n";
+      else
+        rows[g] << values[g] << '\n';
+    }
+  }
+  for (std::size_t g = 0; g < std::size(gauges); ++g) {
+    writeHelp(out, gauges[g].name, gauges[g].help);
+    out << rows[g].str();
+  }
+  return out.str();
+}
+
+void Telemetry::write() {
+  std::string text = prometheusText();
+  std::string temporary = filename + ".tmp";
+  bool written = false;
+  {
+    std::ofstream out(temporary, std::ios::trunc);
+    out << text;
+    out.close();
+    written = static_cast<bool>(out);
+  }
+  std::error_code error;
+  if (written)
+    fs::rename(temporary, filename, error);
+  if ((!written || error) && !reportedError) {
+    // Telemetry must never stop the sweep: report once and keep going
+    std::cerr << "⚠️ Cannot write telemetry file " << filename << std::endl;
+    reportedError = true;
+  }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct SimulationJob;
+
+enum class JobState { Queued, Running, Done, Failed };
+
+// Live state of one job. Only the job's worker writes it, with relaxed
+// atomic stores between growth chunks (never inside a step); the telemetry
+// thread reads it at any time.
+class JobProgress {
+public:
+  JobProgress(const SimulationJob &job, std::chrono::steady_clock::time_point
+                                            epoch);
+
+  void begin(int triangles); // growth starts (or resumes) at `triangles`
+  void update(int triangles, double partitionFunction, double entropyRate,
+              std::size_t memoryBytes);
+  void finish(bool failed);
+
+  // Labels, fixed at construction
+  std::string series;
+  double beta;
+  int targetTriangles;
+  int seed;
+
+  JobState state() const { return current.load(std::memory_order_relaxed); }
+
+private:
+  friend class Telemetry;
+  std::chrono::steady_clock::time_point epoch;
+  std::atomic<JobState> current{JobState::Queued};
+  std::atomic<std::int64_t> startNanos{0};  // since epoch
+  std::atomic<std::int64_t> updateNanos{0}; // last update, since epoch
+  std::atomic<int> startTriangles{0};
+  std::atomic<int> triangles{0};
+  std::atomic<double> partitionFunction{0.0};
+  std::atomic<double> entropyRate{0.0};
+  std::atomic<std::size_t> memoryBytes{0};
+
+  std::int64_t nanosNow() const;
+};
+
+// Opt-in progress report of a sweep (--telemetry FILE): a background thread
+// rewrites FILE every intervalSeconds in the Prometheus text exposition
+// format (atomically, via FILE.tmp and a rename), e.g. for node_exporter's
+// textfile collector or a plain `watch cat`. It holds the number of queued,
+// running, finished and failed jobs and, per running job, triangles,
+// steps/s, ETA, the partition function Z, the entropy rate, the network's
+// memory and the seconds since the job last reported, which exposes a
+// stuck run. Workers never take a lock: only addJob() and the writer do.
+class Telemetry {
+public:
+  Telemetry(std::string filename, double intervalSeconds);
+  ~Telemetry(); // stop()
+
+  Telemetry(const Telemetry &) = delete;
+  Telemetry &operator=(const Telemetry &) = delete;
+
+  // Registers a queued job; the pointer stays valid for this object's life
+  JobProgress *addJob(const SimulationJob &job);
+
+  void start(); // starts the writer thread
+  void stop();  // final write, then joins the writer
+
+  std::string prometheusText() const;
+
+private:
+  std::string filename;
+  std::chrono::duration<double> interval;
+  std::chrono::steady_clock::time_point epoch;
+
+  mutable std::mutex mutex; // jobs and stopping
+  std::deque<JobProgress> jobs;
+  bool stopping = false;
+  std::condition_variable wake;
+  std::thread writer;
+  bool reportedError = false;
+
+  void write();
+};
@@ -0,0 +1,98 @@
+#pragma once
+// Helpers shared by the ctest executables in this directory: CHECK reports a
+// failed condition and lets the test go on, and chiSquare/chiSquareTwoSample
+// compare draw counts without an external statistics library.
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+inline int checkFailures = 0;
+
+#define CHECK(condition, message)                                              \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "FAIL " << __FILE__ << ':' << __LINE__ << ": " << message   \
+                << "\n";                                                       \
+      ++checkFailures;                                                         \
+    }                                                                          \
+  } while (0)
+
+// Returns the exit status of a test executable
+inline int checkResult() {
+  if (checkFailures == 0)
+    std::cout << "passed\n";
+  return checkFailures == 0 ? 0 : 1;
+}
+
+// Pearson χ² statistic, its degrees of freedom, and the standard normal
+// deviate of the statistic (Wilson–Hilferty), so a bound on z is a bound on
+// the p-value whatever the number of bins: z < 4.5 fails with p ≈ 3e-6.
+struct ChiSquare {
+  double statistic = 0.0;
+  int dof = 0;
+  double z() const {
+    if (dof < 1)
+      return 0.0;
+    double k = dof, v = 2.0 / (9.0 * k);
+    return (std::cbrt(statistic / k) - (1.0 - v)) / std::sqrt(v);
+  }
+};
+
+// Observed counts against probabilities p (Σ p = 1). Consecutive bins are
+// pooled until their expected count reaches 5, as the χ² approximation
+// requires; bins with p = 0 must stay empty and are counted as failures.
+inline ChiSquare chiSquare(const std::vector<long long> &observed,
+                           const std::vector<double> &p) {
+  long long draws = 0;
+  for (long long count : observed)
+    draws += count;
+  ChiSquare result;
+  double expected = 0.0, count = 0.0;
+  int bins = 0;
+  for (std::size_t k = 0; k < observed.size(); ++k) {
+    if (p[k] == 0.0) {
+      CHECK(observed[k] == 0, "bin " << k << " has probability 0 but "
+                                     << observed[k] << " draws");
+      continue;
+    }
+    expected += p[k] * draws;
+    count += observed[k];
+    if (expected >= 5.0) {
+      result.statistic += (count - expected) * (count - expected) / expected;
+      ++bins;
+      expected = count = 0.0;
+    }
+  }
+  if (expected > 0.0) { // the remainder is a bin of its own
+    result.statistic += (count - expected) * (count - expected) / expected;
+    ++bins;
+  }
+  result.dof = bins - 1;
+  return result;
+}
+
+// Two samples of equal size: Σ (a - b)² / (a + b) over the bins, pooled
+// until a + b reaches 10, with one degree of freedom per pooled bin less one
+inline ChiSquare chiSquareTwoSample(const std::vector<long long> &a,
+                                    const std::vector<long long> &b) {
+  ChiSquare result;
+  double x = 0.0, y = 0.0;
+  int bins = 0;
+  for (std::size_t k = 0; k < a.size(); ++k) {
+    x += a[k];
+    y += b[k];
+    if (x + y >= 10.0) {
+      result.statistic += (x - y) * (x - y) / (x + y);
+      ++bins;
+      x = y = 0.0;
+    }
+  }
+  if (x + y > 0.0) {
+    result.statistic += (x - y) * (x - y) / (x + y);
+    ++bins;
+  }
+  result.dof = bins - 1;
+  return result;
+}
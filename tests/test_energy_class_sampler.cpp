@@ -0,0 +1,73 @@
+// EnergyClassSampler against Network::sampler on the same network: both must
+// draw links with P(ij) ∝ e^{-βε_ij}(1+n_ij). Fermi-Dirac growth saturates
+// links at m = 2, so it also checks that saturated links leave both samplers.
+
+#include "check.hpp"
+#include "energy_class_sampler.hpp"
+#include "growth_engine.hpp"
+#include "network.hpp"
+
+#include <climits>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+void checkSameDistribution(const char *name, int m, double beta, int steps) {
+  Network net(11, m, beta);
+  net.initialize();
+  // Attached before growth, so it is kept up to date link by link
+  EnergyClassSampler classes(net);
+  GrowthEngine engine(net, 7);
+  engine.growSteps(steps);
+
+  std::vector<double> p(net.numLinks(), 0.0);
+  int saturated = 0;
+  for (int k = 0; k < net.numLinks(); ++k) {
+    p[k] = net.sampler.weight(k) / net.sampler.total();
+    if (net.getLink(k).isSaturated(m))
+      ++saturated;
+  }
+  if (m == 2)
+    CHECK(saturated > net.numLinks() / 4,
+          name << ": only " << saturated << " saturated links");
+
+  const int draws = 2000000;
+  std::mt19937 treeRng(1), classRng(2);
+  std::vector<long long> tree(net.numLinks(), 0), byClass(net.numLinks(), 0);
+  for (int d = 0; d < draws; ++d) {
+    tree[net.sampler.sample(treeRng)]++;
+    byClass[classes.sample(classRng)]++;
+  }
+
+  // Saturated links (p = 0) must never be drawn: chiSquare checks that
+  ChiSquare fit = chiSquare(byClass, p);
+  CHECK(fit.z() < 4.5, name << ": classes vs weights: χ² = " << fit.statistic
+                            << " with " << fit.dof << " dof");
+  ChiSquare agree = chiSquareTwoSample(tree, byClass);
+  CHECK(agree.z() < 4.5, name << ": classes vs tree: χ² = " << agree.statistic
+                              << " with " << agree.dof << " dof");
+
+  // Updated incrementally or rebuilt from the grown network: same sampler
+  EnergyClassSampler rebuilt(net);
+  std::mt19937 a(3), b(3);
+  int differences = 0;
+  for (int d = 0; d < 10000; ++d)
+    if (classes.sample(a) != rebuilt.sample(b))
+      ++differences;
+  CHECK(differences == 0,
+        name << ": " << differences << " draws differ after rebuild");
+
+  std::cout << name << ": " << net.numLinks() << " links (" << saturated
+            << " saturated), " << classes.numLevels()
+            << " levels, classes vs tree χ² = " << agree.statistic << " with "
+            << agree.dof << " dof (z = " << agree.z() << ")\n";
+}
+} // namespace
+
+int main() {
+  checkSameDistribution("fermi beta=1", 2, 1.0, 3000);
+  checkSameDistribution("fermi beta=6", 2, 6.0, 3000);
+  checkSameDistribution("bose beta=1", INT_MAX, 1.0, 3000);
+  return checkResult();
+}
@@ -0,0 +1,94 @@
+// EnsembleAggregator folds runs as they arrive: the summary must not depend
+// on the arrival order (worker threads finish in any order), including runs
+// that were never announced and announced runs that never arrive.
+
+#include "check.hpp"
+#include "ensemble.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// Run k of a group; its entropies of ±1e16 or O(1) make the rounded Welford
+// sums, and so the printed mean and std, depend on the fold order
+std::vector<MetricRow> makeRun(int k, int seed, int steps) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> noise(0.0, 1.0);
+  std::vector<MetricRow> rows;
+  for (int s = 0; s < steps; s += 10) {
+    MetricRow row;
+    row.step = s;
+    row.maxDistance = s / 10 + seed % 3;
+    row.kMax = s + seed % 7;
+    row.entropy = k % 3 == 2 ? noise(rng) : (k % 3 == 0 ? 1e16 : -1e16);
+    rows.push_back(row);
+  }
+  rows.back().avgClustering = noise(rng) / 3.0; // final row only
+  rows.back().modularity = noise(rng);
+  return rows;
+}
+
+std::string summaryOf(const EnsembleAggregator &ensemble) {
+  const char *filename = "test_ensemble_summary.csv";
+  ensemble.writeSummary(filename);
+  std::ifstream in(filename);
+  std::stringstream text;
+  text << in.rdbuf();
+  in.close();
+  std::remove(filename);
+  return text.str();
+}
+
+// Seeds 42, 1042, ...; runs of two groups, added in the order given
+std::string summarize(const std::vector<int> &order, bool announce,
+                      int missing = -1) {
+  EnsembleAggregator ensemble(true);
+  if (announce)
+    for (int k = 0; k < static_cast<int>(order.size()); ++k)
+      for (int N : {500, 900})
+        ensemble.expectRun("fermi_time", 1.0, N, 42 + 1000 * k);
+  for (int k : order) {
+    if (k == missing)
+      continue; // failed run
+    for (int N : {500, 900})
+      ensemble.addRun("fermi_time", 1.0, N, 42 + 1000 * k,
+                      makeRun(k, 42 + 1000 * k + N, N));
+  }
+  return summaryOf(ensemble);
+}
+} // namespace
+
+int main() {
+  const int runs = 12;
+  std::vector<int> inOrder(runs);
+  for (int k = 0; k < runs; ++k)
+    inOrder[k] = k;
+  std::string expected = summarize(inOrder, true);
+  CHECK(expected.find("fermi_time,1,900,890,modularity,12,") !=
+            std::string::npos,
+        "summary lacks the final-row modularity of 12 runs");
+
+  std::mt19937 rng(7);
+  for (int trial = 0; trial < 20; ++trial) {
+    std::vector<int> order = inOrder;
+    std::shuffle(order.begin(), order.end(), rng);
+    CHECK(summarize(order, true) == expected,
+          "announced runs, shuffled order " << trial);
+    CHECK(summarize(order, false) == expected,
+          "unannounced runs, shuffled order " << trial);
+    CHECK(summarize(order, true, 3) == summarize(inOrder, true, 3),
+          "a missing run changes the summary with the order " << trial);
+  }
+
+  // A repeated seed is counted once
+  EnsembleAggregator ensemble;
+  ensemble.addRun("bose_time", 0.5, 100, 42, makeRun(0, 1, 100));
+  ensemble.addRun("bose_time", 0.5, 100, 42, makeRun(1, 2, 100));
+  CHECK(ensemble.runs() == 1, ensemble.runs() << " runs for one seed");
+  return checkResult();
+}
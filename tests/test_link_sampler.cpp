@@ -0,0 +1,86 @@
+// Network::sampler against the full rescan it replaced: after fixed-seed
+// growth, the weight of every link must equal e^{-βε}(1+n) (0 once
+// saturated), and links must be drawn with those probabilities.
+
+#include "check.hpp"
+#include "growth_engine.hpp"
+#include "network.hpp"
+
+#include <climits>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+// The weights the old growOneStep computed for every link on every step
+std::vector<double> rescanWeights(const Network &net) {
+  std::vector<double> weights;
+  for (const Link &link : net.getLinks())
+    weights.push_back(link.isSaturated(net.m)
+                          ? 0.0
+                          : std::exp(-net.beta * link.energy) *
+                                (1 + link.numTriangles));
+  return weights;
+}
+
+void checkGrownNetwork(const char *name, int m, double beta, int steps) {
+  Network net(7, m, beta);
+  net.initialize();
+  GrowthEngine engine(net, 7);
+  engine.growSteps(steps);
+
+  std::vector<double> weights = rescanWeights(net);
+  CHECK(net.sampler.size() == static_cast<int>(weights.size()),
+        name << ": sampler holds " << net.sampler.size() << " links, network "
+             << weights.size());
+  double Z = 0.0;
+  int mismatches = 0;
+  for (std::size_t k = 0; k < weights.size(); ++k) {
+    Z += weights[k];
+    double w = net.sampler.weight(static_cast<int>(k));
+    if (std::abs(w - weights[k]) > 1e-12 * weights[k])
+      ++mismatches;
+  }
+  CHECK(mismatches == 0, name << ": " << mismatches << " link weights differ");
+  CHECK(std::abs(net.sampler.total() - Z) <= 1e-9 * Z,
+        name << ": Z = " << net.sampler.total() << ", rescan " << Z);
+
+  // The old path drew from a discrete_distribution over these weights
+  std::discrete_distribution<int> rescan(weights.begin(), weights.end());
+  std::vector<double> p = rescan.probabilities();
+
+  const int draws = 2000000;
+  std::mt19937 rng(2024);
+  std::vector<long long> counts(weights.size(), 0);
+  for (int d = 0; d < draws; ++d)
+    counts[net.sampler.sample(rng)]++;
+  ChiSquare fit = chiSquare(counts, p);
+  CHECK(fit.z() < 4.5, name << ": χ² = " << fit.statistic << " with "
+                            << fit.dof << " dof (z = " << fit.z() << ")");
+
+  // The test must be able to tell: weights for a β off by 10% are rejected
+  std::vector<double> wrong(weights.size(), 0.0);
+  double wrongZ = 0.0;
+  for (std::size_t k = 0; k < weights.size(); ++k) {
+    const Link &link = net.getLink(static_cast<int>(k));
+    if (weights[k] > 0.0)
+      wrong[k] = std::exp(-1.1 * beta * link.energy) * (1 + link.numTriangles);
+    wrongZ += wrong[k];
+  }
+  for (double &q : wrong)
+    q /= wrongZ;
+  CHECK(chiSquare(counts, wrong).z() > 10.0,
+        name << ": χ² does not reject a wrong distribution");
+
+  std::cout << name << ": " << weights.size() << " links, χ² = "
+            << fit.statistic << " with " << fit.dof << " dof (z = " << fit.z()
+            << ")\n";
+}
+} // namespace
+
+int main() {
+  checkGrownNetwork("fermi beta=0.5", 2, 0.5, 3000);
+  checkGrownNetwork("fermi beta=5", 2, 5.0, 3000);
+  checkGrownNetwork("bose beta=1", INT_MAX, 1.0, 3000);
+  return checkResult();
+}
@@ -0,0 +1,97 @@
+// Louvain regression: cliques joined in a path or ring by single edges, whose
+// partition (one community per clique) and modularity are known exactly,
+// and a grown network, whose reported modularity must be that of the
+// partition returned with it.
+
+#include "check.hpp"
+#include "community.hpp"
+#include "growth_engine.hpp"
+#include "metrics.hpp"
+#include "network.hpp"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+CommunityGraph graphOf(int n, const std::vector<std::pair<int, int>> &edges) {
+  std::vector<std::vector<int>> adjacency(n);
+  for (auto [u, v] : edges) {
+    adjacency[u].push_back(v);
+    adjacency[v].push_back(u);
+  }
+  CommunityGraph g;
+  g.offsets.assign(n + 1, 0);
+  g.selfLoop.assign(n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    g.offsets[i + 1] = g.offsets[i] + static_cast<int>(adjacency[i].size());
+    g.strength.push_back(static_cast<double>(adjacency[i].size()));
+    g.targets.insert(g.targets.end(), adjacency[i].begin(),
+                     adjacency[i].end());
+  }
+  g.weights.assign(g.targets.size(), 1.0);
+  return g;
+}
+
+// `cliques` cliques of k nodes; clique c is joined to clique c + 1 by one
+// edge (a path for two cliques, a ring for more). Q is the modularity of one
+// community per clique, Σ_c [L_in / m - (d_c / 2m)²].
+void checkCliques(int cliques, int k, double Q) {
+  std::vector<std::pair<int, int>> edges;
+  for (int c = 0; c < cliques; ++c)
+    for (int a = 0; a < k; ++a)
+      for (int b = a + 1; b < k; ++b)
+        edges.emplace_back(c * k + a, c * k + b);
+  int bridges = cliques == 2 ? 1 : cliques;
+  for (int c = 0; c < bridges; ++c)
+    edges.emplace_back(c * k, ((c + 1) % cliques) * k + 1);
+  CommunityGraph g = graphOf(cliques * k, edges);
+
+  std::vector<int> byClique(cliques * k);
+  for (int i = 0; i < cliques * k; ++i)
+    byClique[i] = i / k;
+  CHECK(std::abs(Louvain::modularity(g, byClique) - Q) < 1e-12,
+        cliques << " cliques: Q of the clique partition is "
+                << Louvain::modularity(g, byClique) << ", expected " << Q);
+
+  for (int threads : {1, 3}) {
+    CommunityResult result = Louvain::run(g, 4, threads, 42);
+    CHECK(result.numCommunities == cliques,
+          cliques << " cliques: " << result.numCommunities
+                  << " communities on " << threads << " threads");
+    CHECK(std::abs(result.modularity - Q) < 1e-12,
+          cliques << " cliques: Q = " << result.modularity << ", expected "
+                  << Q);
+    bool split = false;
+    for (int i = 0; i < cliques * k; ++i)
+      split = split || result.community[i] != result.community[i / k * k];
+    CHECK(!split, cliques << " cliques: a clique was split");
+  }
+  std::cout << cliques << " cliques of " << k << ": Q = " << Q << "\n";
+}
+} // namespace
+
+int main() {
+  checkCliques(2, 5, 20.0 / 21.0 - 1.0 / 2.0); // m = 21, d_c = 21
+  checkCliques(4, 5, 10.0 / 11.0 - 1.0 / 4.0);  // m = 44, d_c = 22
+  checkCliques(6, 4, 6.0 / 7.0 - 1.0 / 6.0);    // m = 42, d_c = 14
+
+  // On a grown network the reported Q is the modularity of its partition,
+  // and does not depend on the number of threads
+  Network net(3, 2, 1.0);
+  net.initialize();
+  GrowthEngine engine(net, 7);
+  engine.growSteps(5000);
+  CommunityResult one = Metrics::louvain(net, 4, 1, 42);
+  CommunityResult three = Metrics::louvain(net, 4, 3, 42);
+  CHECK(std::abs(one.modularity - Metrics::modularity(net, one.community)) <
+            1e-9,
+        "grown network: Q = " << one.modularity << ", partition has "
+                              << Metrics::modularity(net, one.community));
+  CHECK(one.community == three.community && one.modularity == three.modularity,
+        "grown network: result depends on the number of threads");
+  CHECK(one.modularity > 0.8, "grown network: Q = " << one.modularity);
+  std::cout << "grown network: " << one.numCommunities
+            << " communities, Q = " << one.modularity << "\n";
+  return checkResult();
+}
@@ -0,0 +1,59 @@
+// MetricsTracker against the batch Metrics functions: while a fixed-seed
+// network grows, the incrementally kept k_max, max distance and entropy
+// must equal the full recomputation exactly, not just approximately.
+
+#include "check.hpp"
+#include "growth_engine.hpp"
+#include "metrics.hpp"
+#include "metrics_tracker.hpp"
+#include "network.hpp"
+
+#include <climits>
+#include <vector>
+
+namespace {
+void checkTracker(const char *name, int m, double beta) {
+  Network net(5, m, beta);
+  net.initialize();
+  MetricsTracker tracker(net);
+  GrowthEngine engine(net, 7);
+
+  int step = 0;
+  for (int target : {1, 2, 10, 100, 666, 1000, 5000, 20000}) {
+    engine.growSteps(target - step);
+    step = target;
+    CHECK(tracker.maxDegree() == Metrics::maxDegree(net),
+          name << " step " << step << ": k_max " << tracker.maxDegree()
+               << " != " << Metrics::maxDegree(net));
+    CHECK(tracker.maxDistanceFromInitialTriangle() ==
+              Metrics::maxDistanceFromInitialTriangle(net),
+          name << " step " << step << ": max distance "
+               << tracker.maxDistanceFromInitialTriangle()
+               << " != " << Metrics::maxDistanceFromInitialTriangle(net));
+    CHECK(tracker.entropyRate() == Metrics::entropyRate(net),
+          name << " step " << step << ": entropy " << tracker.entropyRate()
+               << " != " << Metrics::entropyRate(net));
+  }
+
+  // Recomputing from the network must not change anything either
+  int kMax = tracker.maxDegree();
+  int maxDistance = tracker.maxDistanceFromInitialTriangle();
+  double entropy = tracker.entropyRate();
+  tracker.rebuild();
+  CHECK(tracker.maxDegree() == kMax && entropy == tracker.entropyRate() &&
+            tracker.maxDistanceFromInitialTriangle() == maxDistance,
+        name << ": rebuild() changed the tracked metrics");
+
+  std::cout << name << ": k_max = " << kMax << ", max distance = "
+            << maxDistance << ", entropy = " << entropy << " after " << step
+            << " steps\n";
+}
+} // namespace
+
+int main() {
+  checkTracker("fermi beta=0.5", 2, 0.5);
+  checkTracker("fermi beta=3", 2, 3.0);
+  checkTracker("bose beta=0.5", INT_MAX, 0.5);
+  checkTracker("bose beta=3", INT_MAX, 3.0);
+  return checkResult();
+}
@@ -0,0 +1,86 @@
+// ReplicaEnsemble against single Network runs: replica r must grow exactly
+// the network of a single run with seeds[r], link by link, with the same
+// tracked metrics, and replay() must return that network with its rng
+// state. Checked for the scalar and, where the CPU has it, the AVX2 loops.
+
+#include "check.hpp"
+#include "growth_engine.hpp"
+#include "metrics_tracker.hpp"
+#include "network.hpp"
+#include "replica_ensemble.hpp"
+
+#include <climits>
+#include <vector>
+
+namespace {
+void checkReplicas(const char *name, int m, double beta, bool vectorized) {
+  const int replicas = 5, steps = 3000;
+  std::vector<int> seeds;
+  for (int r = 0; r < replicas; ++r)
+    seeds.push_back(42 + 1000 * r); // as --trials
+
+  ReplicaEnsemble ensemble(seeds, m, beta, false, 7);
+  ensemble.setVectorized(vectorized);
+  if (vectorized && !ensemble.isVectorized()) {
+    std::cout << name << " avx2: skipped, no AVX2 on this CPU\n";
+    return;
+  }
+  const char *loops = vectorized ? " avx2" : " scalar";
+  ensemble.initialize();
+  ensemble.grow(steps / 2); // two calls: the trees grow in between
+  ensemble.grow(steps - steps / 2);
+
+  for (int r = 0; r < replicas; ++r) {
+    Network net(seeds[r], m, beta);
+    net.initialize();
+    MetricsTracker tracker(net);
+    GrowthEngine(net, 7).growSteps(steps);
+
+    CHECK(ensemble.numLinks() == net.numLinks(),
+          name << loops << " replica " << r << ": " << ensemble.numLinks()
+               << " links, single run " << net.numLinks());
+    int differences = 0;
+    for (int k = 0; k < net.numLinks() && k < ensemble.numLinks(); ++k) {
+      Link a = ensemble.link(r, k);
+      const Link &b = net.getLink(k);
+      if (a.node1 != b.node1 || a.node2 != b.node2 || a.energy != b.energy ||
+          a.numTriangles != b.numTriangles)
+        ++differences;
+    }
+    CHECK(differences == 0, name << loops << " replica " << r << ": "
+                                 << differences << " links differ");
+    CHECK(ensemble.maxDistance(r) == tracker.maxDistanceFromInitialTriangle() &&
+              ensemble.maxDegree(r) == tracker.maxDegree() &&
+              ensemble.entropyRate(r) == tracker.entropyRate(),
+          name << loops << " replica " << r
+               << ": tracked metrics differ from the single run");
+
+    Network replayed(seeds[r], m, beta);
+    ensemble.replay(r, replayed);
+    int replayDifferences = 0;
+    for (int k = 0; k < net.numLinks() && k < replayed.numLinks(); ++k) {
+      const Link &a = replayed.getLink(k);
+      const Link &b = net.getLink(k);
+      if (a.node1 != b.node1 || a.node2 != b.node2 || a.energy != b.energy ||
+          a.numTriangles != b.numTriangles)
+        ++replayDifferences;
+    }
+    CHECK(replayed.numLinks() == net.numLinks() && replayDifferences == 0,
+          name << loops << " replica " << r << ": replayed network differs in "
+               << replayDifferences << " links");
+    CHECK(replayed.rng == net.rng,
+          name << loops << " replica " << r << ": replayed rng state differs");
+  }
+  std::cout << name << loops << ": " << replicas << " replicas of "
+            << ensemble.numLinks() << " links match their single runs\n";
+}
+} // namespace
+
+int main() {
+  for (bool vectorized : {false, true}) {
+    checkReplicas("fermi beta=0.5", 2, 0.5, vectorized);
+    checkReplicas("fermi beta=3", 2, 3.0, vectorized);
+    checkReplicas("bose beta=1", INT_MAX, 1.0, vectorized);
+  }
+  return checkResult();
+}
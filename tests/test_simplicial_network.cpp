@@ -0,0 +1,79 @@
+// SimplicialNetwork<2> against Network: with the same seed, β and m, its
+// faces must be Network's links in the same order, its rng must end in the
+// same state, and node curvatures and tracked metrics must be equal exactly.
+
+#include "check.hpp"
+#include "growth_engine.hpp"
+#include "metrics_tracker.hpp"
+#include "network.hpp"
+#include "simplicial_network.hpp"
+
+#include <climits>
+
+namespace {
+void checkSameGrowth(const char *name, int m, double beta) {
+  Network net(9, m, beta);
+  net.initialize();
+  MetricsTracker tracker(net);
+  GrowthEngine engine(net, 7);
+  SimplicialNetwork<2> simplicial(9, m, beta);
+  simplicial.initialize();
+  SimplicialGrowthEngine<2> simplicialEngine(simplicial, 7);
+
+  int step = 0;
+  for (int target : {1, 2, 10, 100, 1000, 5000}) {
+    engine.growSteps(target - step);
+    simplicialEngine.growSteps(target - step);
+    step = target;
+
+    CHECK(simplicial.numFaces() == net.numLinks() &&
+              simplicial.numNodes() == net.numNodes(),
+          name << " step " << step << ": " << simplicial.numFaces()
+               << " faces, " << net.numLinks() << " links");
+    int differences = 0;
+    for (int k = 0; k < net.numLinks() && k < simplicial.numFaces(); ++k) {
+      const Face<2> &face = simplicial.getFace(k);
+      const Link &link = net.getLink(k);
+      if (face.nodes[0] != link.node1 || face.nodes[1] != link.node2 ||
+          face.energy != link.energy || face.numSimplices != link.numTriangles)
+        ++differences;
+    }
+    CHECK(differences == 0,
+          name << " step " << step << ": " << differences << " faces differ");
+    CHECK(simplicial.rng == net.rng,
+          name << " step " << step << ": rng states differ");
+
+    int curvatures = 0;
+    for (int i = 0; i < net.numNodes() && i < simplicial.numNodes(); ++i)
+      if (simplicial.nodeCurvature(i) !=
+          1.0 - net.degree(i) / 2.0 + net.triangleCount(i) / 3.0)
+        ++curvatures;
+    CHECK(curvatures == 0,
+          name << " step " << step << ": " << curvatures << " curvatures differ");
+
+    CHECK(simplicial.maxDegree() == tracker.maxDegree(),
+          name << " step " << step << ": k_max " << simplicial.maxDegree()
+               << " != " << tracker.maxDegree());
+    CHECK(simplicial.maxDistanceFromInitialSimplex() ==
+              tracker.maxDistanceFromInitialTriangle(),
+          name << " step " << step << ": max distance "
+               << simplicial.maxDistanceFromInitialSimplex()
+               << " != " << tracker.maxDistanceFromInitialTriangle());
+    CHECK(simplicial.entropyRate() == tracker.entropyRate(),
+          name << " step " << step << ": entropy " << simplicial.entropyRate()
+               << " != " << tracker.entropyRate());
+  }
+
+  std::cout << name << ": " << net.numLinks() << " links, k_max = "
+            << tracker.maxDegree() << ", entropy = " << tracker.entropyRate()
+            << " after " << step << " steps\n";
+}
+} // namespace
+
+int main() {
+  checkSameGrowth("fermi beta=0.5", 2, 0.5);
+  checkSameGrowth("fermi beta=3", 2, 3.0);
+  checkSameGrowth("bose beta=0.5", INT_MAX, 0.5);
+  checkSameGrowth("bose beta=3", INT_MAX, 3.0);
+  return checkResult();
+}